@@ -14,6 +14,8 @@ import com.hypermagik.spectrum.lib.dsp.Resampler
 import com.hypermagik.spectrum.lib.dsp.Shifter
 import com.hypermagik.spectrum.lib.dsp.Taps
 import com.hypermagik.spectrum.lib.dsp.Utils.Companion.toRadians
+import com.hypermagik.spectrum.lib.gpu.GPUAPI
+import com.hypermagik.spectrum.lib.gpu.VulkanShiftDecimator
 import com.hypermagik.spectrum.lib.loop.PLL
 import com.hypermagik.spectrum.utils.TAG
 
@@ -24,7 +26,9 @@ class WFM(private val preferences: Preferences) : Demodulator {
     private val quadratureRate = 250000
     private val quadratureDeviation = 75000
 
-    private var resampler = Resampler(sampleRate, quadratureRate, preferences.demodulatorGPUAPI)
+    // Whether the resampler was created to run the mono audio chain on the GPU, the app then only receives the audio.
+    private var resamplerGPUAudio = false
+    private var resampler = createResampler()
     private var quadrature = Quadrature(quadratureRate, quadratureDeviation)
     private var lowPassFIR = FIR(Taps.halfBand(), 2, true)
 
@@ -44,6 +48,7 @@ class WFM(private val preferences: Preferences) : Demodulator {
 
     private val audioTaps = Taps.lowPass(125000f, 14000.0f, 5000.0f)
     private var audioFIRs = arrayOf(FIR(audioTaps, 4), FIR(audioTaps, 4))
+    private val audioSampleRate = 31250
 
     private var audioSink: AudioSink? = null
 
@@ -60,7 +65,7 @@ class WFM(private val preferences: Preferences) : Demodulator {
 
     init {
         if (preferences.demodulatorAudio) {
-            audioSink = AudioSink(31250, 0.5f)
+            audioSink = AudioSink(audioSampleRate, 0.5f)
         }
 
         if (preferences.demodulatorRDS) {
@@ -68,6 +73,29 @@ class WFM(private val preferences: Preferences) : Demodulator {
         }
     }
 
+    private fun createResampler(): Resampler {
+        var resampler: Resampler? = null
+
+        if (resamplerGPUAudio && preferences.demodulatorGPUAPI == GPUAPI.Vulkan) {
+            // Same filters as the CPU mono path.
+            val demodulator = VulkanShiftDecimator.Demodulator(quadratureDeviation, arrayOf(Taps.halfBand(), audioTaps), intArrayOf(2, 4), 50e-6f)
+            resampler = Resampler(sampleRate, quadratureRate, preferences.demodulatorGPUAPI, demodulator = demodulator)
+
+            if (!resampler.demodulates) {
+                resampler.close()
+                resampler = null
+            }
+        }
+
+        if (resampler == null) {
+            resampler = Resampler(sampleRate, quadratureRate, preferences.demodulatorGPUAPI)
+        }
+
+        resampler.setShiftFrequency(-shiftFrequency)
+
+        return resampler
+    }
+
     override fun getChannelBandwidth(): Int = quadratureRate
 
     override fun setFrequency(frequency: Long) {
@@ -89,13 +117,33 @@ class WFM(private val preferences: Preferences) : Demodulator {
             observe(buffer, true)
         }
 
-        if (sampleRate != buffer.sampleRate) {
-            Log.d(TAG, "Sample rate changed from $sampleRate to ${buffer.sampleRate}")
-            sampleRate = buffer.sampleRate
+        // Mono audio without RDS is demodulated on the GPU, unless the channel or the quadrature output is observed.
+        val gpuAudio = audioSink != null && !preferences.demodulatorStereo && rdsDemodulator == null && output != 1 && output != 2
+
+        // The resampler keeps the history of the previous blocks, it is recreated rather than left idle when the mode changes.
+        if (sampleRate != buffer.sampleRate || gpuAudio != resamplerGPUAudio) {
+            if (sampleRate != buffer.sampleRate) {
+                Log.d(TAG, "Sample rate changed from $sampleRate to ${buffer.sampleRate}")
+                sampleRate = buffer.sampleRate
+            }
+            resamplerGPUAudio = gpuAudio
 
             resampler.close()
-            resampler = Resampler(sampleRate, quadratureRate, preferences.demodulatorGPUAPI)
-            resampler.setShiftFrequency(-shiftFrequency)
+            resampler = createResampler()
+        }
+
+        if (resampler.demodulates) {
+            buffer.sampleCount = resampler.resample(buffer.samples, buffer.samples, buffer.sampleCount)
+            buffer.sampleRate = audioSampleRate
+            buffer.frequency -= shiftFrequency.toLong()
+            buffer.realSamples = true
+
+            audioSink?.play(buffer.samples, buffer.samples, buffer.sampleCount)
+
+            if (output == 3) {
+                observe(buffer, false)
+            }
+            return
         }
 
         buffer.sampleCount = resampler.resample(buffer.samples, buffer.samples, buffer.sampleCount)
@@ -3,12 +3,17 @@ package com.hypermagik.spectrum.benchmark
 import androidx.benchmark.junit4.BenchmarkRule
 import androidx.benchmark.junit4.measureRepeated
 import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
 import com.hypermagik.spectrum.lib.data.Complex32
 import com.hypermagik.spectrum.lib.data.Complex32Array
 import com.hypermagik.spectrum.lib.dsp.FFT
+import com.hypermagik.spectrum.lib.gpu.Vulkan
+import com.hypermagik.spectrum.lib.gpu.VulkanSpectrum
 import org.junit.Rule
 import org.junit.Test
 import org.junit.runner.RunWith
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 
 @RunWith(AndroidJUnit4::class)
 class FFT {
@@ -45,4 +50,32 @@ class FFT {
             fft.fft(samples)
         }
     }
+
+    @Test
+    fun fft32768vulkan() {
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val uut = VulkanSpectrum(32768)
+        val samples = Complex32Array(32768) { Complex32() }
+        val output = FloatArray(32768)
+
+        benchmarkRule.measureRepeated {
+            uut.analyze(samples, samples.size, output)
+        }
+    }
+
+    @Test
+    fun fft1048576vulkan() {
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val uut = VulkanSpectrum(1048576)
+        val samples = ByteBuffer.allocateDirect(1048576 * 2 * Float.SIZE_BYTES).order(ByteOrder.nativeOrder())
+        val output = FloatArray(1048576)
+
+        benchmarkRule.measureRepeated {
+            uut.analyze(samples, 1048576, output)
+        }
+    }
 }
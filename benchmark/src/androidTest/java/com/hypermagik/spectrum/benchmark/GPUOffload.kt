@@ -1,5 +1,7 @@
 package com.hypermagik.spectrum.benchmark
 
+import android.os.ParcelFileDescriptor
+import android.util.Log
 import androidx.benchmark.junit4.BenchmarkRule
 import androidx.benchmark.junit4.measureRepeated
 import androidx.test.ext.junit.runners.AndroidJUnit4
@@ -9,10 +11,19 @@ import com.hypermagik.spectrum.lib.data.Complex32Array
 import com.hypermagik.spectrum.lib.gpu.GLESShiftDecimator
 import com.hypermagik.spectrum.lib.gpu.GLES
 import com.hypermagik.spectrum.lib.gpu.Vulkan
+import com.hypermagik.spectrum.lib.gpu.VulkanIQFile
 import com.hypermagik.spectrum.lib.gpu.VulkanShiftDecimator
 import org.junit.Rule
 import org.junit.Test
 import org.junit.runner.RunWith
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.util.concurrent.Executors
+import kotlin.math.PI
+import kotlin.math.cos
+import kotlin.math.log10
+import kotlin.math.sin
 
 @RunWith(AndroidJUnit4::class)
 class GPUOffload {
@@ -45,16 +56,214 @@ class GPUOffload {
 
     @Test
     fun decimator64vulkan() {
+        decimatorVulkan(64, false)
+    }
+
+    // Both stages of every block on one queue, for comparison with decimator64vulkan, which alternates blocks between two queues
+    // and runs the first stage of a block while the second stage of the previous block is still running.
+    @Test
+    fun decimator64vulkanSingleQueue() {
+        decimatorVulkan(64, false, forceSingleQueue = true)
+    }
+
+    // As above with every slot of the ring in flight, so more than two blocks overlap on the two queues.
+    @Test
+    fun decimator64vulkanDeep() {
+        decimatorVulkan(64, false, depth = VulkanShiftDecimator.MAX_DEPTH)
+    }
+
+    @Test
+    fun decimator64vulkanDeepSingleQueue() {
+        decimatorVulkan(64, false, forceSingleQueue = true, depth = VulkanShiftDecimator.MAX_DEPTH)
+    }
+
+    // Two single queue instances decimating on two threads, assigned different queues of the context where it has more than one.
+    @Test
+    fun decimator64vulkanTwoInstances() {
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val uuts = Array(2) { VulkanShiftDecimator(1000000, 64, forceSingleQueue = true) }
+        uuts.forEach { it.setShiftFrequency(-100001.0f) }
+
+        val inputs = Array(uuts.size) { Complex32Array(128 * 1024) { Complex32() } }
+        val outputs = Array(uuts.size) { Complex32Array(128 * 1024 / 64) { Complex32() } }
+
+        val executor = Executors.newFixedThreadPool(uuts.size)
+
+        benchmarkRule.measureRepeated {
+            val futures = uuts.indices.map { i -> executor.submit { uuts[i].decimate(inputs[i], outputs[i], inputs[i].size) } }
+            futures.forEach { it.get() }
+        }
+
+        executor.shutdown()
+        uuts.forEach { it.close() }
+    }
+
+    // Blocks split into 8 chunks of 16K samples, all submitted at once, against decimator64vulkan with one 128K block per submission.
+    @Test
+    fun decimator64vulkanBatched() {
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val uut = VulkanShiftDecimator(1000000, 64, depth = VulkanShiftDecimator.MAX_DEPTH, maxBlockSize = 16 * 1024)
+        uut.setShiftFrequency(-100001.0f)
+
+        val input = Complex32Array(128 * 1024) { Complex32() }
+        val output = Complex32Array(128 * 1024 / 64) { Complex32() }
+
+        benchmarkRule.measureRepeated {
+            uut.decimate(input, output, input.size)
+        }
+
+        uut.close()
+    }
+
+    @Test
+    fun decimator64vulkanBakedTaps() {
+        decimatorVulkan(64, true)
+    }
+
+    @Test
+    fun decimator4vulkan() {
+        decimatorVulkan(4, false)
+    }
+
+    @Test
+    fun decimator4vulkanBakedTaps() {
+        decimatorVulkan(4, true)
+    }
+
+    @Test
+    fun decimator64vulkanHalfPrecision() {
+        reportHalfPrecision(64)
+        decimatorVulkan(64, false, true)
+    }
+
+    @Test
+    fun decimator4vulkanHalfPrecision() {
+        reportHalfPrecision(4)
+        decimatorVulkan(4, false, true)
+    }
+
+    // Raw RTL-SDR bytes, converted on the GPU instead of by an IQ converter.
+    @Test
+    fun decimator64vulkanU8() {
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val uut = VulkanShiftDecimator(1000000, 64, sampleFormat = VulkanShiftDecimator.SampleFormat.U8)
+        uut.setShiftFrequency(-100001.0f)
+
+        val input = ByteBuffer.allocateDirect(128 * 1024 * 2).order(ByteOrder.nativeOrder())
+        val output = Complex32Array(128 * 1024 / 64) { Complex32() }
+
+        benchmarkRule.measureRepeated {
+            uut.decimate(input, output, 128 * 1024)
+        }
+    }
+
+    // Samples written to the mapped staging buffer and outputs read from the mapped output buffer.
+    @Test
+    fun decimator64vulkanInPlace() {
         Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
 
         val uut = VulkanShiftDecimator(1000000, 64)
         uut.setShiftFrequency(-100001.0f)
 
+        val input = FloatArray(128 * 1024 * 2)
+        val output = FloatArray(128 * 1024 / 64 * 2)
+
+        benchmarkRule.measureRepeated {
+            uut.stagingBuffer().asFloatBuffer().put(input)
+            val count = uut.decimateInPlace(128 * 1024)
+            uut.outputBuffer().asFloatBuffer().get(output, 0, count * 2)
+        }
+    }
+
+    // Raw RTL-SDR recording played back from a mapped file, imported into Vulkan where the driver allows.
+    @Test
+    fun decimator64vulkanIQFile() {
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val file = File.createTempFile("iq", ".cu8", InstrumentationRegistry.getInstrumentation().targetContext.cacheDir)
+        file.writeBytes(ByteArray(16 * 128 * 1024 * 2))
+
+        val fd = ParcelFileDescriptor.open(file, ParcelFileDescriptor.MODE_READ_ONLY)
+        val iqFile = VulkanIQFile(fd, 0, VulkanShiftDecimator.SampleFormat.U8)
+        fd.close()
+
+        val uut = VulkanShiftDecimator(1000000, 64, sampleFormat = VulkanShiftDecimator.SampleFormat.U8)
+        uut.setShiftFrequency(-100001.0f)
+
+        val output = Complex32Array(128 * 1024 / 64) { Complex32() }
+
+        benchmarkRule.measureRepeated {
+            uut.decimate(iqFile, output, 128 * 1024)
+        }
+
+        uut.close()
+        iqFile.close()
+        file.delete()
+    }
+
+    // Stages have 9, 9, 9, 11, 21 and 41 taps with ratio 64, 21 and 41 taps with ratio 4.
+    private fun decimatorVulkan(ratio: Int, bakeTaps: Boolean, halfPrecision: Boolean = false, forceSingleQueue: Boolean = false, depth: Int = 2) {
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val uut = VulkanShiftDecimator(1000000, ratio, forceSingleQueue = forceSingleQueue, depth = depth, bakeTaps = bakeTaps, halfPrecision = halfPrecision)
+        uut.setShiftFrequency(-100001.0f)
+
         val input = Complex32Array(128 * 1024) { Complex32() }
-        val output = Complex32Array(2 * 1024) { Complex32() }
+        val output = Complex32Array(128 * 1024 / ratio) { Complex32() }
 
         benchmarkRule.measureRepeated {
             uut.decimate(input, output, input.size)
         }
     }
+
+    // Logs the SNR of half precision against single precision output for a tone in the output band,
+    // and how much of a tone outside the output band aliases into it with either precision.
+    private fun reportHalfPrecision(ratio: Int) {
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val sampleRate = 1000000
+        val outputRate = sampleRate / ratio
+
+        val inBand = decimateTone(ratio, outputRate / 8.0f)
+        val outOfBand = decimateTone(ratio, outputRate * 0.75f)
+
+        var signal = 0.0
+        var noise = 0.0
+        for (i in inBand[0].indices) {
+            signal += inBand[0][i] * inBand[0][i]
+            noise += (inBand[0][i] - inBand[1][i]) * (inBand[0][i] - inBand[1][i])
+        }
+
+        val snr = 10 * log10(signal / noise)
+        val aliasing = DoubleArray(2) { 10 * log10(outOfBand[it].sumOf { x -> (x * x).toDouble() } / (outOfBand[it].size / 2)) }
+
+        Log.i("GPUOffload", "Half precision, ratio: $ratio, SNR: %.1f dB, aliasing: %.1f dBc (single precision: %.1f dBc)"
+            .format(snr, aliasing[1], aliasing[0]))
+    }
+
+    // Interleaved output of a full scale tone, with single and half precision.
+    private fun decimateTone(ratio: Int, frequency: Float): Array<FloatArray> {
+        val omega = 2 * PI * frequency / 1000000
+        val blocks = Array(2) { block ->
+            Complex32Array(128 * 1024) {
+                val phi = omega * (block * 128 * 1024 + it)
+                Complex32(cos(phi).toFloat(), sin(phi).toFloat())
+            }
+        }
+
+        return Array(2) { precision ->
+            val uut = VulkanShiftDecimator(1000000, ratio, halfPrecision = precision == 1)
+            val output = Complex32Array(128 * 1024 / ratio) { Complex32() }
+
+            // The first block only fills the pipeline.
+            uut.decimate(blocks[0], output, blocks[0].size)
+            val count = uut.decimate(blocks[1], output, blocks[1].size)
+            uut.close()
+
+            FloatArray(count * 2) { if (it % 2 == 0) output[it / 2].re else output[it / 2].im }
+        }
+    }
 }
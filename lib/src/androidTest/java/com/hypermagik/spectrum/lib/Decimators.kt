@@ -2,18 +2,37 @@ package com.hypermagik.spectrum.lib
 
 import android.util.Log
 import androidx.test.ext.junit.runners.AndroidJUnit4
+import android.os.ParcelFileDescriptor
 import androidx.test.platform.app.InstrumentationRegistry
 import com.hypermagik.spectrum.lib.data.Complex32
 import com.hypermagik.spectrum.lib.data.Complex32Array
+import com.hypermagik.spectrum.lib.data.SampleType
+import com.hypermagik.spectrum.lib.data.converter.IQConverterFactory
+import com.hypermagik.spectrum.lib.demod.Quadrature
 import com.hypermagik.spectrum.lib.dsp.Decimator
+import com.hypermagik.spectrum.lib.dsp.Deemphasis
+import com.hypermagik.spectrum.lib.dsp.FIR
+import com.hypermagik.spectrum.lib.dsp.Polyphase
+import com.hypermagik.spectrum.lib.dsp.RootRaisedCosine
+import com.hypermagik.spectrum.lib.dsp.Taps
 import com.hypermagik.spectrum.lib.gpu.GLES
 import com.hypermagik.spectrum.lib.gpu.GLESShiftDecimator
 import com.hypermagik.spectrum.lib.gpu.Vulkan
+import com.hypermagik.spectrum.lib.gpu.VulkanChannelizer
+import com.hypermagik.spectrum.lib.gpu.VulkanIQFile
 import com.hypermagik.spectrum.lib.gpu.VulkanShiftDecimator
 import org.junit.Test
 import org.junit.runner.RunWith
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import kotlin.concurrent.thread
+import kotlin.math.PI
 import kotlin.math.abs
+import kotlin.math.cos
 import kotlin.math.max
+import kotlin.math.sin
+import kotlin.random.Random
 
 @RunWith(AndroidJUnit4::class)
 class Decimators {
@@ -56,4 +75,831 @@ class Decimators {
         check(error1 < 2e-7)
         check(error2 < 2e-7)
     }
-}
\ No newline at end of file
+
+    @Test
+    fun vulkanHandlesVariableBlockSizes() {
+        val random = Random(1)
+        val samples = Complex32Array(8192) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val decimator1 = VulkanShiftDecimator(1, 64)
+        val output1 = Complex32Array(128) { Complex32() }
+        decimator1.decimate(samples, output1, samples.size)
+        check(decimator1.decimate(samples, output1, samples.size) == 128)
+        decimator1.close()
+
+        val decimator2 = VulkanShiftDecimator(1, 64)
+        val output2 = Complex32Array(128) { Complex32() }
+        val blocks = intArrayOf(1000, 3001, 4191)
+        var offset = 0
+        var outputLength = 0
+
+        for (i in 0..blocks.size) {
+            val length = if (i < blocks.size) blocks[i] else 0
+            val input = Complex32Array(length) { samples[offset + it] }
+            val output = Complex32Array(128) { Complex32() }
+            val count = decimator2.decimate(input, output, length)
+            for (j in 0 until count) {
+                output2[outputLength + j].set(output[j])
+            }
+            offset += length
+            outputLength += count
+        }
+        decimator2.close()
+
+        check(outputLength == 128)
+
+        var error = 0.0f
+
+        for (i in 0 until 128) {
+            error = max(error, abs(output1[i].re - output2[i].re))
+            error = max(error, abs(output1[i].im - output2[i].im))
+        }
+
+        Log.d("Decimators", "Vulkan variable block size error: $error")
+
+        check(error < 1e-6)
+    }
+
+    @Test
+    fun vulkanDepthOnlyAddsLatency() {
+        val random = Random(2)
+        val blocks = Array(8) { Complex32Array(4096) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val outputs = Array(2) { Array(blocks.size) { Complex32Array(64) { Complex32() } } }
+
+        for ((i, depth) in intArrayOf(VulkanShiftDecimator.MIN_DEPTH, VulkanShiftDecimator.MAX_DEPTH).withIndex()) {
+            val decimator = VulkanShiftDecimator(1, 64, depth = depth)
+            for (j in blocks.indices) {
+                val count = decimator.decimate(blocks[j], outputs[i][j], blocks[j].size)
+                check(count == if (j < depth - 1) 0 else 64)
+            }
+            decimator.close()
+        }
+
+        val latency = VulkanShiftDecimator.MAX_DEPTH - VulkanShiftDecimator.MIN_DEPTH
+
+        for (j in latency until blocks.size) {
+            for (k in 0 until 64) {
+                check(outputs[0][j - latency][k] == outputs[1][j][k])
+            }
+        }
+    }
+
+    @Test
+    fun vulkanBakedTapsHaveSameOutput() {
+        val random = Random(6)
+        val samples = Complex32Array(8192) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val output1 = Complex32Array(128) { Complex32() }
+        val output2 = Complex32Array(128) { Complex32() }
+
+        for ((bakeTaps, output) in listOf(false to output1, true to output2)) {
+            val decimator = VulkanShiftDecimator(1000000, 64, bakeTaps = bakeTaps)
+            decimator.setShiftFrequency(-100001.0f)
+            decimator.decimate(samples, output, samples.size)
+            check(decimator.decimate(samples, output, samples.size) == 128)
+            decimator.close()
+        }
+
+        var error = 0.0f
+
+        for (i in 0 until 128) {
+            error = max(error, abs(output1[i].re - output2[i].re))
+            error = max(error, abs(output1[i].im - output2[i].im))
+        }
+
+        Log.d("Decimators", "Vulkan baked taps error: $error")
+
+        check(error < 1e-6)
+    }
+
+    @Test
+    fun vulkanHalfPrecisionIsClose() {
+        val random = Random(7)
+        val samples = Complex32Array(8192) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val output1 = Complex32Array(128) { Complex32() }
+        val output2 = Complex32Array(128) { Complex32() }
+
+        for ((halfPrecision, output) in listOf(false to output1, true to output2)) {
+            val decimator = VulkanShiftDecimator(1000000, 64, halfPrecision = halfPrecision)
+            decimator.setShiftFrequency(-100001.0f)
+            decimator.decimate(samples, output, samples.size)
+            check(decimator.decimate(samples, output, samples.size) == 128)
+            decimator.close()
+        }
+
+        var error = 0.0f
+
+        for (i in 0 until 128) {
+            error = max(error, abs(output1[i].re - output2[i].re))
+            error = max(error, abs(output1[i].im - output2[i].im))
+        }
+
+        Log.d("Decimators", "Vulkan half precision error: $error")
+
+        check(error < 1e-2)
+    }
+
+    @Test
+    fun vulkanRawSamplesMatchConverters() {
+        val random = Random(8)
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        for (type in listOf(SampleType.U8, SampleType.S8, SampleType.S12P)) {
+            val converter = IQConverterFactory.create(type)
+            val raw = ByteBuffer.allocateDirect(8192 * converter.getSampleSize()).order(ByteOrder.nativeOrder())
+            while (raw.hasRemaining()) {
+                if (type == SampleType.S12P) {
+                    raw.putShort((random.nextInt(4096) - 2048).toShort())
+                } else {
+                    raw.put(random.nextInt(256).toByte())
+                }
+            }
+            raw.rewind()
+
+            val samples = Complex32Array(8192) { Complex32() }
+            converter.convert(raw, samples)
+            raw.rewind()
+
+            val output1 = Complex32Array(128) { Complex32() }
+            val output2 = Complex32Array(128) { Complex32() }
+
+            val decimator1 = VulkanShiftDecimator(1000000, 64)
+            decimator1.setShiftFrequency(-100001.0f)
+            decimator1.decimate(samples, output1, samples.size)
+            check(decimator1.decimate(samples, output1, samples.size) == 128)
+            decimator1.close()
+
+            val decimator2 = VulkanShiftDecimator(1000000, 64, sampleFormat = VulkanShiftDecimator.SampleFormat.of(type))
+            decimator2.setShiftFrequency(-100001.0f)
+            decimator2.decimate(raw, output2, samples.size)
+            check(decimator2.decimate(raw, output2, samples.size) == 128)
+            decimator2.close()
+
+            var error = 0.0f
+
+            for (i in 0 until 128) {
+                error = max(error, abs(output1[i].re - output2[i].re))
+                error = max(error, abs(output1[i].im - output2[i].im))
+            }
+
+            Log.d("Decimators", "Vulkan raw $type error: $error")
+
+            check(error < 1e-6)
+        }
+    }
+
+    @Test
+    fun vulkanInPlaceMatchesCopies() {
+        val random = Random(9)
+        val blocks = Array(4) { FloatArray(8192 * 2) { random.nextFloat() - 0.5f } }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val decimator1 = VulkanShiftDecimator(1000000, 64)
+        val decimator2 = VulkanShiftDecimator(1000000, 64)
+        decimator1.setShiftFrequency(-100001.0f)
+        decimator2.setShiftFrequency(-100001.0f)
+
+        val input = ByteBuffer.allocateDirect(8192 * 2 * Float.SIZE_BYTES).order(ByteOrder.nativeOrder())
+        val output1 = Complex32Array(128) { Complex32() }
+        val output2 = FloatArray(128 * 2)
+
+        for (block in blocks) {
+            input.asFloatBuffer().put(block)
+            val count1 = decimator1.decimate(input, output1, 8192)
+
+            decimator2.stagingBuffer().asFloatBuffer().put(block)
+            val count2 = decimator2.decimateInPlace(8192)
+            decimator2.outputBuffer().asFloatBuffer().get(output2, 0, count2 * 2)
+
+            check(count1 == count2)
+
+            for (i in 0 until count1) {
+                check(output1[i].re == output2[2 * i + 0] && output1[i].im == output2[2 * i + 1])
+            }
+        }
+
+        decimator1.close()
+        decimator2.close()
+    }
+
+    @Test
+    fun vulkanIQFileMatchesBuffers() {
+        val random = Random(10)
+        // Two and a half blocks, so every other block wraps around.
+        val samples = ByteArray(20480 * 2) { random.nextInt(256).toByte() }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // Without a header blocks are page aligned and can be imported, with a header they are copied.
+        for (headerSize in intArrayOf(0, 44)) {
+            val file = File.createTempFile("iq", ".cu8", InstrumentationRegistry.getInstrumentation().targetContext.cacheDir)
+            file.writeBytes(ByteArray(headerSize) + samples)
+
+            val fd = ParcelFileDescriptor.open(file, ParcelFileDescriptor.MODE_READ_ONLY)
+            val iqFile = VulkanIQFile(fd, headerSize.toLong(), VulkanShiftDecimator.SampleFormat.U8)
+            fd.close()
+
+            val decimator1 = VulkanShiftDecimator(1000000, 64, sampleFormat = VulkanShiftDecimator.SampleFormat.U8)
+            val decimator2 = VulkanShiftDecimator(1000000, 64, sampleFormat = VulkanShiftDecimator.SampleFormat.U8)
+            decimator1.setShiftFrequency(-100001.0f)
+            decimator2.setShiftFrequency(-100001.0f)
+
+            val input = ByteBuffer.allocateDirect(8192 * 2)
+            val output1 = Complex32Array(128) { Complex32() }
+            val output2 = Complex32Array(128) { Complex32() }
+
+            for (block in 0 until 6) {
+                input.clear()
+                for (i in 0 until 8192 * 2) {
+                    input.put(samples[(block * 8192 * 2 + i) % samples.size])
+                }
+                input.rewind()
+
+                val count1 = decimator1.decimate(input, output1, 8192)
+                val count2 = decimator2.decimate(iqFile, output2, 8192)
+
+                check(count1 == count2)
+
+                for (i in 0 until count1) {
+                    check(output1[i].re == output2[i].re && output1[i].im == output2[i].im)
+                }
+            }
+
+            decimator1.close()
+            decimator2.close()
+            iqFile.close()
+            file.delete()
+        }
+    }
+
+    @Test
+    fun vulkanResamplerMatchesCPU() {
+        val random = Random(3)
+        val blocks = Array(4) { Complex32Array(8192) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // 1 MS/s to 36 kS/s, 16x decimation followed by 72/125 resampling.
+        val taps = Taps.lowPass(62500.0f * 72, 18000.0f, 72 * 9)
+        for (i in taps.indices) {
+            taps[i] = taps[i] * 72
+        }
+
+        val decimator1 = VulkanShiftDecimator(1, 16)
+        val polyphase = Polyphase(72, 125, taps)
+        val decimator2 = VulkanShiftDecimator(1, 16, interpolation = 72, decimation = 125, resamplerTaps = taps)
+
+        var error = 0.0f
+        var outputLength = 0
+
+        for (block in blocks) {
+            val output1 = Complex32Array(512) { Complex32() }
+            val output2 = Complex32Array(512) { Complex32() }
+
+            var count1 = decimator1.decimate(block, output1, block.size)
+            count1 = polyphase.filter(output1, output1, count1)
+            val count2 = decimator2.decimate(block, output2, block.size)
+
+            check(count1 == count2)
+
+            for (i in 0 until count1) {
+                error = max(error, abs(output1[i].re - output2[i].re))
+                error = max(error, abs(output1[i].im - output2[i].im))
+            }
+
+            outputLength += count2
+        }
+
+        decimator1.close()
+        decimator2.close()
+
+        Log.d("Decimators", "Vulkan resampler error: $error, outputs: $outputLength")
+
+        check(outputLength > 0)
+        check(error < 1e-5)
+    }
+
+    @Test
+    fun vulkanFilterMatchesCPU() {
+        val random = Random(5)
+        val blocks = Array(4) { Complex32Array(8192) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // 1 MS/s to 36 kS/s as for Tetra, then a root raised cosine matched filter at 2 samples per symbol, decimated to symbols.
+        val taps = Taps.lowPass(62500.0f * 72, 18000.0f, 72 * 9)
+        for (i in taps.indices) {
+            taps[i] = taps[i] * 72
+        }
+        val rrcTaps = RootRaisedCosine.make(2, 65, 0.35f)
+
+        val decimator1 = VulkanShiftDecimator(1, 16, interpolation = 72, decimation = 125, resamplerTaps = taps)
+        val fir = FIR(rrcTaps, 2)
+        val decimator2 = VulkanShiftDecimator(
+            1, 16, interpolation = 72, decimation = 125, resamplerTaps = taps, filterTaps = rrcTaps, filterDecimation = 2
+        )
+
+        // Outputs of a block can differ by the sample carried over to the next one, the streams are compared.
+        val outputs1 = ArrayList<Complex32>()
+        val outputs2 = ArrayList<Complex32>()
+
+        for (block in blocks) {
+            val output1 = Complex32Array(512) { Complex32() }
+            val output2 = Complex32Array(512) { Complex32() }
+
+            var count1 = decimator1.decimate(block, output1, block.size)
+            count1 = fir.filter(output1, output1, count1)
+            val count2 = decimator2.decimate(block, output2, block.size)
+
+            check(abs(count1 - count2) <= 1)
+
+            for (i in 0 until count1) {
+                outputs1.add(Complex32(output1[i].re, output1[i].im))
+            }
+            for (i in 0 until count2) {
+                outputs2.add(Complex32(output2[i].re, output2[i].im))
+            }
+        }
+
+        decimator1.close()
+        decimator2.close()
+
+        var error = 0.0f
+        val outputLength = minOf(outputs1.size, outputs2.size)
+
+        for (i in 0 until outputLength) {
+            error = max(error, abs(outputs1[i].re - outputs2[i].re))
+            error = max(error, abs(outputs1[i].im - outputs2[i].im))
+        }
+
+        Log.d("Decimators", "Vulkan filter error: $error, outputs: $outputLength")
+
+        check(outputLength > 0)
+        check(error < 1e-5)
+    }
+
+    @Test
+    fun vulkanDemodulatorMatchesCPU() {
+        // 1 kHz tone at 50 kHz deviation, sampled at 1 MS/s.
+        var phase = 0.0
+        val blocks = Array(4) { block ->
+            Complex32Array(8192) {
+                val t = (block * 8192 + it) / 1e6
+                phase += 2 * PI * 50000 * sin(2 * PI * 1000 * t) / 1e6
+                Complex32(cos(phase).toFloat(), sin(phase).toFloat())
+            }
+        }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // Mono wideband FM chain, 250 kS/s to 31.25 kS/s audio.
+        val halfBandTaps = Taps.halfBand()
+        val audioTaps = Taps.lowPass(125000f, 14000.0f, 5000.0f)
+
+        val decimator1 = VulkanShiftDecimator(1000000, 4)
+        val quadrature = Quadrature(250000, 75000)
+        val firs = arrayOf(FIR(halfBandTaps, 2, true), FIR(audioTaps, 4))
+        val deemphasis = Deemphasis(50e-6f)
+
+        val demodulator = VulkanShiftDecimator.Demodulator(75000, arrayOf(halfBandTaps, audioTaps), intArrayOf(2, 4), 50e-6f)
+        val decimator2 = VulkanShiftDecimator(1000000, 4, demodulator = demodulator)
+
+        var error = 0.0f
+        var outputLength = 0
+
+        for (block in blocks) {
+            val output1 = Complex32Array(2048) { Complex32() }
+            val output2 = Complex32Array(2048) { Complex32() }
+
+            var count1 = decimator1.decimate(block, output1, block.size)
+            if (count1 > 0) {
+                quadrature.demodulate(output1, output1, count1)
+                for (fir in firs) {
+                    count1 = fir.filter(output1, output1, count1)
+                }
+                deemphasis.filter(output1, 31250, count1)
+            }
+            val count2 = decimator2.decimate(block, output2, block.size)
+
+            check(count1 == count2)
+
+            for (i in 0 until count1) {
+                error = max(error, abs(output1[i].re - output2[i].re))
+                error = max(error, abs(output2[i].im))
+            }
+
+            outputLength += count2
+        }
+
+        decimator1.close()
+        decimator2.close()
+
+        Log.d("Decimators", "Vulkan demodulator error: $error, outputs: $outputLength")
+
+        check(outputLength > 0)
+        check(error < 1e-4)
+    }
+
+    @Test
+    fun vulkanChannelsMatchSeparateDecimators() {
+        val random = Random(4)
+        val blocks = Array(4) { Complex32Array(8192) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+        val frequencies = floatArrayOf(-250000.0f, 0.0f, 125000.0f)
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val decimator = VulkanShiftDecimator(1000000, 64, channels = frequencies.size)
+        val decimators = Array(frequencies.size) { VulkanShiftDecimator(1000000, 64) }
+
+        for ((i, frequency) in frequencies.withIndex()) {
+            decimator.setShiftFrequency(i, frequency)
+            decimators[i].setShiftFrequency(frequency)
+        }
+
+        var error = 0.0f
+
+        for (block in blocks) {
+            val outputs = Array(frequencies.size) { Complex32Array(128) { Complex32() } }
+            val count = decimator.decimate(block, outputs, block.size)
+
+            for (i in frequencies.indices) {
+                val output = Complex32Array(128) { Complex32() }
+                check(decimators[i].decimate(block, output, block.size) == count)
+
+                for (j in 0 until count) {
+                    error = max(error, abs(output[j].re - outputs[i][j].re))
+                    error = max(error, abs(output[j].im - outputs[i][j].im))
+                }
+            }
+        }
+
+        decimator.close()
+        decimators.forEach { it.close() }
+
+        Log.d("Decimators", "Vulkan channels error: $error")
+
+        check(error < 1e-6)
+    }
+
+    @Test
+    fun vulkanChunkedBlocksMatchWholeBlocks() {
+        val random = Random(11)
+        val blocks = Array(4) { Complex32Array(65536) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+        val frequencies = floatArrayOf(-250000.0f, 125000.0f)
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // Blocks are split into 8 chunks by the second decimator, which only shortens its latency.
+        val decimator1 = VulkanShiftDecimator(1000000, 64, channels = frequencies.size)
+        val decimator2 = VulkanShiftDecimator(1000000, 64, channels = frequencies.size, maxBlockSize = 8192)
+
+        for ((i, frequency) in frequencies.withIndex()) {
+            decimator1.setShiftFrequency(i, frequency)
+            decimator2.setShiftFrequency(i, frequency)
+        }
+
+        val outputs1 = Array(frequencies.size) { Complex32Array(blocks.size * 1024) { Complex32() } }
+        val outputs2 = Array(frequencies.size) { Complex32Array(blocks.size * 1024) { Complex32() } }
+        var outputLength1 = 0
+        var outputLength2 = 0
+
+        for (block in blocks) {
+            val output1 = Array(frequencies.size) { Complex32Array(1024) { Complex32() } }
+            val output2 = Array(frequencies.size) { Complex32Array(1024) { Complex32() } }
+            val count1 = decimator1.decimate(block, output1, block.size)
+            val count2 = decimator2.decimate(block, output2, block.size)
+
+            for (i in frequencies.indices) {
+                for (j in 0 until count1) {
+                    outputs1[i][outputLength1 + j].set(output1[i][j])
+                }
+                for (j in 0 until count2) {
+                    outputs2[i][outputLength2 + j].set(output2[i][j])
+                }
+            }
+
+            outputLength1 += count1
+            outputLength2 += count2
+        }
+
+        decimator1.close()
+        decimator2.close()
+
+        check(outputLength1 == (blocks.size - 1) * 1024)
+        check(outputLength2 == blocks.size * 1024 - 128)
+
+        var error = 0.0f
+
+        for (i in frequencies.indices) {
+            for (j in 0 until outputLength1) {
+                error = max(error, abs(outputs1[i][j].re - outputs2[i][j].re))
+                error = max(error, abs(outputs1[i][j].im - outputs2[i][j].im))
+            }
+        }
+
+        Log.d("Decimators", "Vulkan chunked block error: $error")
+
+        // Shifter phases of the chunks are computed separately, within float precision.
+        check(error < 1e-4)
+    }
+
+    @Test
+    fun vulkanLargeBlocksMatchMaxSizeBlocks() {
+        val random = Random(12)
+        val blockSize = VulkanShiftDecimator.MAX_BLOCK_SIZE
+        val blocks = Array(2) { Complex32Array(2 * blockSize) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // The second decimator gets blocks twice the maximum block size, larger than the arrays it starts with.
+        val decimator1 = VulkanShiftDecimator(1000000, 64)
+        val decimator2 = VulkanShiftDecimator(1000000, 64)
+        decimator1.setShiftFrequency(-250000.0f)
+        decimator2.setShiftFrequency(-250000.0f)
+
+        val outputLength = blocks.size * 2 * blockSize / 64
+        val outputs1 = Complex32Array(outputLength) { Complex32() }
+        val outputs2 = Complex32Array(outputLength) { Complex32() }
+        var outputLength1 = 0
+        var outputLength2 = 0
+
+        val input = Complex32Array(blockSize) { Complex32() }
+        val output = Complex32Array(outputLength) { Complex32() }
+
+        for (block in blocks) {
+            for (i in 0 until 2) {
+                for (j in 0 until blockSize) {
+                    input[j].set(block[i * blockSize + j])
+                }
+                val count = decimator1.decimate(input, output, blockSize)
+                for (j in 0 until count) {
+                    outputs1[outputLength1 + j].set(output[j])
+                }
+                outputLength1 += count
+            }
+
+            val count = decimator2.decimate(block, output, block.size)
+            for (j in 0 until count) {
+                outputs2[outputLength2 + j].set(output[j])
+            }
+            outputLength2 += count
+        }
+
+        var count = decimator1.flush(output)
+        for (j in 0 until count) {
+            outputs1[outputLength1 + j].set(output[j])
+        }
+        outputLength1 += count
+
+        count = decimator2.flush(output)
+        for (j in 0 until count) {
+            outputs2[outputLength2 + j].set(output[j])
+        }
+        outputLength2 += count
+
+        decimator1.close()
+        decimator2.close()
+
+        check(outputLength1 == outputLength)
+        check(outputLength2 == outputLength)
+
+        var error = 0.0f
+
+        for (j in 0 until outputLength) {
+            error = max(error, abs(outputs1[j].re - outputs2[j].re))
+            error = max(error, abs(outputs1[j].im - outputs2[j].im))
+        }
+
+        Log.d("Decimators", "Vulkan large block error: $error")
+
+        // Shifter phases of the chunks are computed separately, within float precision.
+        check(error < 1e-4)
+    }
+
+    @Test
+    fun vulkanParallelInstancesMatchSingleInstance() {
+        val random = Random(12)
+        val blocks = Array(16) { Complex32Array(8192) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // Decimates all blocks and returns the output of each.
+        val run = {
+            val decimator = VulkanShiftDecimator(1000000, 64)
+            decimator.setShiftFrequency(-100001.0f)
+            val outputs = Array(blocks.size) { Complex32Array(128) { Complex32() } }
+            for (i in blocks.indices) {
+                decimator.decimate(blocks[i], outputs[i], blocks[i].size)
+            }
+            decimator.close()
+            outputs
+        }
+
+        val expected = run()
+
+        // Instances on different threads record and submit their commands at the same time.
+        val outputs = arrayOfNulls<Array<Complex32Array>>(4)
+        val threads = Array(outputs.size) { i -> thread { outputs[i] = run() } }
+        threads.forEach { it.join() }
+
+        for (output in outputs) {
+            for (i in blocks.indices) {
+                for (j in 0 until 128) {
+                    check(output!![i][j] == expected[i][j])
+                }
+            }
+        }
+    }
+
+    @Test
+    fun vulkanAsyncMatchesProcess() {
+        val random = Random(13)
+        val blocks = Array(12) { Complex32Array(8192) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val depth = 4
+
+        // Blocks returned by process, the tail is flushed after the last one.
+        val decimator1 = VulkanShiftDecimator(1000000, 64, depth = depth)
+        decimator1.setShiftFrequency(-100001.0f)
+        val outputs1 = Complex32Array(blocks.size * 128) { Complex32() }
+        var outputLength1 = 0
+        val output = Complex32Array(depth * 128) { Complex32() }
+        for (block in blocks) {
+            val count = decimator1.decimate(block, output, block.size)
+            for (j in 0 until count) {
+                outputs1[outputLength1 + j].set(output[j])
+            }
+            outputLength1 += count
+        }
+        val count = decimator1.flush(output)
+        for (j in 0 until count) {
+            outputs1[outputLength1 + j].set(output[j])
+        }
+        outputLength1 += count
+        decimator1.close()
+
+        // Blocks submitted while the ring has a free slot and returned as they complete.
+        val decimator2 = VulkanShiftDecimator(1000000, 64, depth = depth)
+        decimator2.setShiftFrequency(-100001.0f)
+        val outputs2 = Complex32Array(blocks.size * 128) { Complex32() }
+        var outputLength2 = 0
+        var nextSequence = 0L
+        val collect = { completion: VulkanShiftDecimator.Completion ->
+            check(completion.sequence == nextSequence++)
+            check(completion.completionTime >= completion.submitTime)
+            for (j in 0 until completion.outputLength) {
+                outputs2[outputLength2 + j].set(output[j])
+            }
+            outputLength2 += completion.outputLength
+        }
+        for ((i, block) in blocks.withIndex()) {
+            while (decimator2.inFlight == decimator2.slotCount) {
+                decimator2.poll(output)?.let(collect)
+            }
+            check(decimator2.submit(block, block.size, i.toLong()))
+        }
+        while (decimator2.inFlight > 0) {
+            collect(decimator2.await(nextSequence, output))
+        }
+        decimator2.close()
+
+        check(outputLength1 == blocks.size * 128)
+        check(outputLength2 == outputLength1)
+
+        for (j in 0 until outputLength1) {
+            check(outputs1[j] == outputs2[j])
+        }
+    }
+
+    @Test
+    fun vulkanBatchedSubmitMatchesSingleBlocks() {
+        val random = Random(14)
+        val blocks = Array(3) { Complex32Array(32768) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) } }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // Every block is split into 4 chunks submitted together by the second decimator.
+        val decimator1 = VulkanShiftDecimator(1000000, 64, depth = 4, maxBlockSize = 8192)
+        val decimator2 = VulkanShiftDecimator(1000000, 64, depth = 4, maxBlockSize = 8192)
+        decimator1.setShiftFrequency(-100001.0f)
+        decimator2.setShiftFrequency(-100001.0f)
+
+        val block = Complex32Array(8192) { Complex32() }
+        val output1 = Complex32Array(128) { Complex32() }
+        val output2 = Complex32Array(128) { Complex32() }
+
+        var error = 0.0f
+
+        for ((i, input) in blocks.withIndex()) {
+            for (j in 0 until 4) {
+                for (k in 0 until 8192) {
+                    block[k].set(input[j * 8192 + k])
+                }
+                check(decimator1.submit(block, block.size, 4L * i + j))
+            }
+            check(decimator2.submit(input, input.size, 4L * i))
+
+            for (j in 0 until 4) {
+                val completion1 = decimator1.await(4L * i + j, output1)
+                val completion2 = decimator2.await(4L * i + j, output2)
+                check(completion1.outputLength == 128 && completion2.outputLength == 128)
+                for (k in 0 until 128) {
+                    error = max(error, abs(output1[k].re - output2[k].re))
+                    error = max(error, abs(output1[k].im - output2[k].im))
+                }
+            }
+        }
+
+        decimator1.close()
+        decimator2.close()
+
+        Log.d("Decimators", "Vulkan batched submit error: $error")
+
+        // Shifter phases of the chunks are computed separately, within float precision.
+        check(error < 1e-4)
+    }
+
+    @Test
+    fun vulkanChannelizerSeparatesTones() {
+        // Tones at the centers of channel 3 and channel 12, which is -4 / 16 of the sample rate.
+        val blocks = Array(4) { block ->
+            Complex32Array(8192) {
+                val n = block * 8192 + it
+                val a = 2 * PI * (3 * n % 16) / 16
+                val b = 2 * PI * (12 * n % 16) / 16
+                Complex32((cos(a) + 0.5 * cos(b)).toFloat(), (sin(a) + 0.5 * sin(b)).toFloat())
+            }
+        }
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        // Two times oversampled.
+        val channelizer = VulkanChannelizer(16, 8)
+
+        var error = 0.0f
+        var leakage = 0.0f
+        var outputLength = 0
+
+        for (block in blocks) {
+            val outputs = Array(16) { Complex32Array(1025) { Complex32() } }
+            val count = channelizer.channelize(block, outputs, block.size)
+
+            for (j in 0 until count) {
+                // Centered tones are at DC in their channels.
+                error = max(error, abs(outputs[3][j].mag() - 1.0f))
+                error = max(error, abs(outputs[12][j].mag() - 0.5f))
+                if (j > 0) {
+                    error = max(error, abs(outputs[3][j].re - outputs[3][j - 1].re))
+                    error = max(error, abs(outputs[3][j].im - outputs[3][j - 1].im))
+                }
+
+                for (i in 0 until 16) {
+                    if (i !in 2..4 && i !in 11..13) {
+                        leakage = max(leakage, outputs[i][j].mag())
+                    }
+                }
+            }
+
+            outputLength += count
+        }
+
+        channelizer.close()
+
+        Log.d("Decimators", "Vulkan channelizer error: $error, leakage: $leakage, outputs: $outputLength")
+
+        check(outputLength > 0)
+        check(error < 1e-3)
+        check(leakage < 1e-3)
+    }
+}
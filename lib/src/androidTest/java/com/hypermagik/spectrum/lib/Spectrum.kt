@@ -0,0 +1,88 @@
+package com.hypermagik.spectrum.lib
+
+import android.util.Log
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import com.hypermagik.spectrum.lib.data.Complex32
+import com.hypermagik.spectrum.lib.data.Complex32Array
+import com.hypermagik.spectrum.lib.dsp.FFT
+import com.hypermagik.spectrum.lib.dsp.Window
+import com.hypermagik.spectrum.lib.gpu.Vulkan
+import com.hypermagik.spectrum.lib.gpu.VulkanSpectrum
+import org.junit.Test
+import org.junit.runner.RunWith
+import kotlin.math.abs
+import kotlin.math.log10
+import kotlin.math.max
+import kotlin.random.Random
+
+@RunWith(AndroidJUnit4::class)
+class Spectrum {
+    @Test
+    fun vulkanSpectrumMatchesCPU() {
+        val random = Random(5)
+
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val spectrum = VulkanSpectrum(65536)
+
+        // Transformed in shared memory only and after radix-4 passes.
+        for (size in intArrayOf(16, 4096, 65536)) {
+            val samples = Complex32Array(size) { Complex32(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f) }
+            val window = Window.make(Window.Type.BLACKMAN_HARRIS, size)
+
+            val output = FloatArray(size)
+            val peaks = FloatArray(size)
+            spectrum.setWindow(window)
+            spectrum.analyze(samples, size, output, peaks)
+
+            val fft = FFT(size)
+            val magnitudes = FloatArray(size)
+            Window.apply(window, samples)
+            fft.fft(samples)
+            fft.magnitudes(samples, magnitudes, size)
+
+            var error = 0.0f
+            for (i in 0 until size) {
+                error = max(error, abs(output[i] - 20.0f * log10(magnitudes[i])))
+                check(output[i] == peaks[i])
+            }
+
+            Log.d("Spectrum", "Vulkan spectrum size: $size, error: $error dB")
+
+            check(error < 0.01f)
+        }
+
+        spectrum.close()
+    }
+
+    @Test
+    fun vulkanSpectrumHoldsPeaks() {
+        System.loadLibrary("spectrum")
+        Vulkan.init(InstrumentationRegistry.getInstrumentation().context)
+
+        val spectrum = VulkanSpectrum(1024)
+        spectrum.averaging = 0.5f
+
+        val tone = Complex32Array(1024) { Complex32(1.0f, 0.0f) }
+        val silence = Complex32Array(1024) { Complex32(1e-3f, 0.0f) }
+
+        val output = FloatArray(1024)
+        val peaks = FloatArray(1024)
+
+        spectrum.analyze(tone, 1024, output, peaks)
+        check(abs(output[512]) < 1e-3f)
+
+        // Half of the power is averaged away, the peak stays.
+        spectrum.analyze(silence, 1024, output, peaks)
+        check(abs(output[512] + 3.0103f) < 1e-2f)
+        check(abs(peaks[512]) < 1e-3f)
+
+        spectrum.reset()
+        spectrum.analyze(silence, 1024, output, peaks)
+        check(abs(peaks[512] + 60.0f) < 1e-2f)
+
+        spectrum.close()
+    }
+}
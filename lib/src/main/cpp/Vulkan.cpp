@@ -10,7 +10,12 @@ std::unique_ptr<Vulkan::Context> context;
 
 extern "C"
 JNIEXPORT jboolean JNICALL
-Java_com_hypermagik_spectrum_lib_gpu_Vulkan_00024Companion_createContext(JNIEnv *env, jobject thiz, jboolean debug, jobject _assetManager) {
+Java_com_hypermagik_spectrum_lib_gpu_Vulkan_00024Companion_createContext(JNIEnv *env, jobject thiz, jboolean debug, jobject _assetManager, jstring _pipelineCachePath) {
+    // Instances on other threads keep using the context, it lives as long as the process.
+    if (context != nullptr) {
+        return true;
+    }
+
     void *libVulkanHandle = Vulkan::Loader::loadVulkan({
              // {"vulkan.adreno.so", "vulkan.freedreno.so"}
     });
@@ -18,6 +23,15 @@ Java_com_hypermagik_spectrum_lib_gpu_Vulkan_00024Companion_createContext(JNIEnv
 
     VK_CHECK(Vulkan::initializePFN(libVulkanHandle));
 
-    context = Vulkan::Context::create(debug, AAssetManager_fromJava(env, _assetManager));
+    const char *pipelineCachePath = env->GetStringUTFChars(_pipelineCachePath, nullptr);
+    context = Vulkan::Context::create(debug, AAssetManager_fromJava(env, _assetManager), pipelineCachePath);
+    env->ReleaseStringUTFChars(_pipelineCachePath, pipelineCachePath);
+
     return context != nullptr;
 }
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_Vulkan_00024Companion_supportsTimelineSemaphores(JNIEnv *, jobject) {
+    return context != nullptr && context->supportsTimelineSemaphores();
+}
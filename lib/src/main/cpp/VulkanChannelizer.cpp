@@ -0,0 +1,45 @@
+#include "vulkan/dsp/Channelizer.h"
+
+#include <jni.h>
+#include <android/log.h>
+
+extern std::unique_ptr<Vulkan::Context> context;
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanChannelizer_00024Companion_create(JNIEnv *env, jobject, jfloatArray _taps, jint branches, jint decimation, jint depth) {
+    if (context == nullptr || branches <= 0 || decimation <= 0 || depth < 0) {
+        return 0;
+    }
+    std::vector<float> taps(env->GetArrayLength(_taps));
+    env->GetFloatArrayRegion(_taps, 0, (jsize) taps.size(), taps.data());
+    auto instance = Vulkan::DSP::Channelizer::create(context.get(), std::move(taps), branches, decimation, depth);
+    context->savePipelineCache();
+    return (jlong) instance.release();
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanChannelizer_00024Companion_process(JNIEnv *env, jobject, jlong _instance, jobject samples, jint sampleCount, jobject output) {
+    auto *instance = (Vulkan::DSP::Channelizer *) _instance;
+    if (instance == nullptr) {
+        return 0;
+    }
+    auto *sampleBuffer = (const float *) env->GetDirectBufferAddress(samples);
+    auto *outputBuffer = (float *) env->GetDirectBufferAddress(output);
+    if (env->GetDirectBufferCapacity(output) < (jlong) S2B(instance->channelCount() * instance->maxOutputCount())) {
+        return 0;
+    }
+    size_t outputCount = 0;
+    if (!instance->process(sampleBuffer, sampleCount, outputBuffer, outputCount)) {
+        return 0;
+    }
+    return (jint) outputCount;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanChannelizer_00024Companion_delete(JNIEnv *env, jobject, jlong _instance) {
+    auto *instance = (Vulkan::DSP::Channelizer *) _instance;
+    delete instance;
+}
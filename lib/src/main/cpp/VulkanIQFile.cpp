@@ -0,0 +1,22 @@
+#include "vulkan/dsp/IQFile.h"
+
+#include <jni.h>
+#include <android/log.h>
+
+extern std::unique_ptr<Vulkan::Context> context;
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanIQFile_00024Companion_create(JNIEnv *env, jobject, jint fd, jlong headerSize, jint sampleFormat) {
+    if (context == nullptr || fd < 0 || headerSize < 0 || !Vulkan::DSP::isValidSampleFormat(sampleFormat)) {
+        return 0;
+    }
+    return (jlong) Vulkan::DSP::IQFile::create(context.get(), fd, headerSize, (Vulkan::DSP::SampleFormat) sampleFormat).release();
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanIQFile_00024Companion_delete(JNIEnv *env, jobject, jlong _instance) {
+    auto *instance = (Vulkan::DSP::IQFile *) _instance;
+    delete instance;
+}
@@ -1,5 +1,6 @@
 #include "vulkan/dsp/ShiftDecimatorSingleQueue.h"
 #include "vulkan/dsp/ShiftDecimatorMultiQueue.h"
+#include "vulkan/dsp/IQFile.h"
 
 #include <jni.h>
 #include <android/log.h>
@@ -8,26 +9,226 @@
 extern std::unique_ptr<Vulkan::Context> context;
 
 static Vulkan::DSP::Taps getTaps(JNIEnv *env, jobject _taps);
+static Vulkan::DSP::Resampler getResampler(JNIEnv *env, jint interpolation, jint decimation, jfloatArray taps);
+static Vulkan::DSP::Filter getFilter(JNIEnv *env, jfloatArray taps, jint decimation);
+static Vulkan::DSP::Demodulator getDemodulator(JNIEnv *env, jfloat gain, jobject taps, jintArray decimations, jfloat deemphasis);
+static void setCompletion(JNIEnv *env, jlongArray completion, const Vulkan::DSP::ShiftDecimator::Completion &);
+static float *getOutputBuffer(JNIEnv *env, jobject output, size_t size);
 
 extern "C"
 JNIEXPORT jlong JNICALL
-Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_create(JNIEnv *env, jobject, jobject taps, jboolean forceSingleQueue) {
-    if (context == nullptr) {
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_create(JNIEnv *env, jobject, jobject taps, jboolean forceSingleQueue, jint depth, jint channels,
+                                                                                jint interpolation, jint decimation, jfloatArray resamplerTaps, jboolean bakeTaps,
+                                                                                jboolean halfPrecision, jint sampleFormat, jint maxBlockSize, jfloatArray filterTaps,
+                                                                                jint filterDecimation, jfloat demodulatorGain, jobject demodulatorTaps,
+                                                                                jintArray demodulatorDecimations, jfloat deemphasis) {
+    if (context == nullptr || depth < 0 || channels <= 0 || interpolation <= 0 || decimation <= 0 || !Vulkan::DSP::isValidSampleFormat(sampleFormat) ||
+        maxBlockSize <= 0 || filterDecimation <= 0) {
         return 0;
     }
-    return forceSingleQueue || context->queueCount() == 1
-           ? (jlong) Vulkan::DSP::ShiftDecimatorSingleQueue::create(context.get(), getTaps(env, taps)).release()
-           : (jlong) Vulkan::DSP::ShiftDecimatorMultiQueue::create(context.get(), getTaps(env, taps)).release();
+    auto resampler = getResampler(env, interpolation, decimation, resamplerTaps);
+    auto filter = getFilter(env, filterTaps, filterDecimation);
+    auto demodulator = getDemodulator(env, demodulatorGain, demodulatorTaps, demodulatorDecimations, deemphasis);
+    auto format = (Vulkan::DSP::SampleFormat) sampleFormat;
+    std::unique_ptr<Vulkan::DSP::ShiftDecimator> instance;
+    if (forceSingleQueue || context->queueCount() == 1) {
+        instance = Vulkan::DSP::ShiftDecimatorSingleQueue::create(context.get(), getTaps(env, taps), std::move(resampler), std::move(filter), std::move(demodulator), depth, channels, format, maxBlockSize, bakeTaps, halfPrecision);
+    } else {
+        instance = Vulkan::DSP::ShiftDecimatorMultiQueue::create(context.get(), getTaps(env, taps), std::move(resampler), std::move(filter), std::move(demodulator), depth, channels, format, maxBlockSize, bakeTaps, halfPrecision);
+    }
+    // Pipelines of the instance are ready on the next start.
+    context->savePipelineCache();
+    return (jlong) instance.release();
 }
 
 extern "C"
-JNIEXPORT void JNICALL
-Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_process(JNIEnv *env, jobject, jlong _instance, jobject samples, jint sampleCount, jfloat phi, jfloat omega) {
+JNIEXPORT jint JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_process(JNIEnv *env, jobject, jlong _instance, jobject samples, jint sampleCount, jobject output,
+                                                                                 jfloatArray _phi, jfloatArray _omega) {
     auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
-    if (instance != nullptr) {
-        auto *sampleBuffer = (float *) env->GetDirectBufferAddress(samples);
-        instance->process(sampleBuffer, sampleCount, phi, omega);
+    if (instance == nullptr) {
+        return -1;
+    }
+    // Every channel of the instance needs a phase and a frequency, the arrays are copied into arrays of MAX_CHANNELS.
+    const jsize channels = env->GetArrayLength(_phi);
+    if ((size_t) channels != instance->channelCount() || env->GetArrayLength(_omega) != channels) {
+        return -1;
     }
+    float phi[MAX_CHANNELS];
+    float omega[MAX_CHANNELS];
+    env->GetFloatArrayRegion(_phi, 0, channels, phi);
+    env->GetFloatArrayRegion(_omega, 0, channels, omega);
+    // Samples written to the staging buffer and output read in place are passed as null.
+    const auto *sampleBuffer = samples != nullptr ? env->GetDirectBufferAddress(samples) : nullptr;
+    // Blocks split into chunks return the outputs of several chunks.
+    auto *outputBuffer = output != nullptr ? getOutputBuffer(env, output, instance->maxOutputSize(sampleCount)) : nullptr;
+    if (output != nullptr && outputBuffer == nullptr) {
+        return -1;
+    }
+    size_t outputCount = 0;
+    if (!instance->process(sampleBuffer, sampleCount, outputBuffer, outputCount, phi, omega)) {
+        return -1;
+    }
+    return (jint) outputCount;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_processFile(JNIEnv *env, jobject, jlong _instance, jlong _file, jint sampleCount, jobject output,
+                                                                                     jfloatArray _phi, jfloatArray _omega) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    auto *file = (Vulkan::DSP::IQFile *) _file;
+    if (instance == nullptr || file == nullptr) {
+        return -1;
+    }
+    // Every channel of the instance needs a phase and a frequency, the arrays are copied into arrays of MAX_CHANNELS.
+    const jsize channels = env->GetArrayLength(_phi);
+    if ((size_t) channels != instance->channelCount() || env->GetArrayLength(_omega) != channels) {
+        return -1;
+    }
+    float phi[MAX_CHANNELS];
+    float omega[MAX_CHANNELS];
+    env->GetFloatArrayRegion(_phi, 0, channels, phi);
+    env->GetFloatArrayRegion(_omega, 0, channels, omega);
+    auto *outputBuffer = getOutputBuffer(env, output, instance->maxOutputSize(sampleCount));
+    if (outputBuffer == nullptr) {
+        return -1;
+    }
+    size_t outputCount = 0;
+    if (!file->decimate(*instance, sampleCount, outputBuffer, outputCount, phi, omega)) {
+        return -1;
+    }
+    return (jint) outputCount;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_flush(JNIEnv *env, jobject, jlong _instance, jobject output) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    if (instance == nullptr) {
+        return -1;
+    }
+    auto *outputBuffer = getOutputBuffer(env, output, instance->flushSize());
+    if (outputBuffer == nullptr) {
+        return -1;
+    }
+    size_t outputCount = 0;
+    if (!instance->flush(outputBuffer, outputCount)) {
+        return -1;
+    }
+    return (jint) outputCount;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_submit(JNIEnv *env, jobject, jlong _instance, jobject samples, jint sampleCount,
+                                                                                jlong sequence, jfloatArray _phi, jfloatArray _omega) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    if (instance == nullptr) {
+        return false;
+    }
+    // Every channel of the instance needs a phase and a frequency, the arrays are copied into arrays of MAX_CHANNELS.
+    const jsize channels = env->GetArrayLength(_phi);
+    if ((size_t) channels != instance->channelCount() || env->GetArrayLength(_omega) != channels) {
+        return false;
+    }
+    float phi[MAX_CHANNELS];
+    float omega[MAX_CHANNELS];
+    env->GetFloatArrayRegion(_phi, 0, channels, phi);
+    env->GetFloatArrayRegion(_omega, 0, channels, omega);
+    // Samples written to the staging buffer are passed as null.
+    const auto *sampleBuffer = samples != nullptr ? env->GetDirectBufferAddress(samples) : nullptr;
+    return instance->submit(sampleBuffer, sampleCount, sequence, phi, omega);
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_poll(JNIEnv *env, jobject, jlong _instance, jobject output, jlongArray completion) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    if (instance == nullptr) {
+        return false;
+    }
+    // Output read in place is passed as null.
+    auto *outputBuffer = output != nullptr ? getOutputBuffer(env, output, instance->outputBufferSize()) : nullptr;
+    if (output != nullptr && outputBuffer == nullptr) {
+        return false;
+    }
+    Vulkan::DSP::ShiftDecimator::Completion result;
+    bool completed = false;
+    if (!instance->poll(outputBuffer, result, completed) || !completed) {
+        return false;
+    }
+    setCompletion(env, completion, result);
+    return true;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_await(JNIEnv *env, jobject, jlong _instance, jlong sequence, jobject output,
+                                                                               jlongArray completion) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    if (instance == nullptr) {
+        return false;
+    }
+    auto *outputBuffer = output != nullptr ? getOutputBuffer(env, output, instance->outputBufferSize()) : nullptr;
+    if (output != nullptr && outputBuffer == nullptr) {
+        return false;
+    }
+    Vulkan::DSP::ShiftDecimator::Completion result;
+    if (!instance->wait(sequence, outputBuffer, result)) {
+        return false;
+    }
+    setCompletion(env, completion, result);
+    return true;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_inFlight(JNIEnv *env, jobject, jlong _instance) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    return instance != nullptr ? (jint) instance->inFlight() : 0;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_slotCount(JNIEnv *env, jobject, jlong _instance) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    return instance != nullptr ? (jint) instance->slotCount() : 0;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_currentSlot(JNIEnv *env, jobject, jlong _instance) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    return instance != nullptr ? (jint) instance->currentSlot() : 0;
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_outputStride(JNIEnv *env, jobject, jlong _instance) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    return instance != nullptr ? (jint) instance->outputStride() : 0;
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_stagingBuffer(JNIEnv *env, jobject, jlong _instance, jint slot) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    if (instance == nullptr || slot < 0 || (size_t) slot >= instance->slotCount()) {
+        return nullptr;
+    }
+    return env->NewDirectByteBuffer(instance->stagingBuffer(slot), (jlong) instance->stagingSize());
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanShiftDecimator_00024Companion_outputBuffer(JNIEnv *env, jobject, jlong _instance, jint slot) {
+    auto *instance = (Vulkan::DSP::ShiftDecimator *) _instance;
+    if (instance == nullptr || slot < 0 || (size_t) slot >= instance->slotCount()) {
+        return nullptr;
+    }
+    // The view is writable, but the buffer is only ever written by the GPU.
+    return env->NewDirectByteBuffer((void *) instance->outputBuffer(slot), (jlong) instance->outputBufferSize());
 }
 
 extern "C"
@@ -57,3 +258,62 @@ static Vulkan::DSP::Taps getTaps(JNIEnv *env, jobject taps) {
 
     return result;
 }
+
+static Vulkan::DSP::Resampler getResampler(JNIEnv *env, jint interpolation, jint decimation, jfloatArray taps) {
+    Vulkan::DSP::Resampler result;
+
+    result.interpolation = interpolation;
+    result.decimation = decimation;
+    result.taps.resize(env->GetArrayLength(taps));
+
+    env->GetFloatArrayRegion(taps, 0, (jsize) result.taps.size(), result.taps.data());
+
+    return result;
+}
+
+static Vulkan::DSP::Filter getFilter(JNIEnv *env, jfloatArray taps, jint decimation) {
+    Vulkan::DSP::Filter result;
+
+    result.taps.resize(env->GetArrayLength(taps));
+    result.decimation = decimation;
+
+    env->GetFloatArrayRegion(taps, 0, (jsize) result.taps.size(), result.taps.data());
+
+    return result;
+}
+
+static Vulkan::DSP::Demodulator getDemodulator(JNIEnv *env, jfloat gain, jobject taps, jintArray decimations, jfloat deemphasis) {
+    Vulkan::DSP::Demodulator result;
+
+    result.gain = gain;
+    result.taps = getTaps(env, taps);
+    result.decimations.resize(env->GetArrayLength(decimations));
+    result.deemphasis = deemphasis;
+
+    env->GetIntArrayRegion(decimations, 0, (jsize) result.decimations.size(), (jint *) result.decimations.data());
+
+    return result;
+}
+
+// Must match the order read by VulkanShiftDecimator.Completion.
+static void setCompletion(JNIEnv *env, jlongArray completion, const Vulkan::DSP::ShiftDecimator::Completion &result) {
+    const jlong values[] = {
+            (jlong) result.sequence,
+            (jlong) result.slot,
+            (jlong) result.outputCount,
+            (jlong) result.submitTime,
+            (jlong) result.completionTime,
+            (jlong) result.gpuTime,
+    };
+    env->SetLongArrayRegion(completion, 0, sizeof(values) / sizeof(values[0]), values);
+}
+
+// Address of a direct buffer of at least size bytes, null for other buffers, whose capacity is -1.
+static float *getOutputBuffer(JNIEnv *env, jobject output, size_t size) {
+    auto *address = (float *) env->GetDirectBufferAddress(output);
+    const jlong capacity = env->GetDirectBufferCapacity(output);
+    if (address == nullptr || capacity < 0 || (size_t) capacity < size) {
+        return nullptr;
+    }
+    return address;
+}
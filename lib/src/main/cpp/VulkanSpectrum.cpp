@@ -0,0 +1,58 @@
+#include "vulkan/dsp/Spectrum.h"
+
+#include <jni.h>
+#include <android/log.h>
+
+extern std::unique_ptr<Vulkan::Context> context;
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanSpectrum_00024Companion_create(JNIEnv *env, jobject, jint maxSize) {
+    if (context == nullptr || maxSize <= 0) {
+        return 0;
+    }
+    auto instance = Vulkan::DSP::Spectrum::create(context.get(), maxSize);
+    context->savePipelineCache();
+    return (jlong) instance.release();
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanSpectrum_00024Companion_setWindow(JNIEnv *env, jobject, jlong _instance, jfloatArray _window) {
+    auto *instance = (Vulkan::DSP::Spectrum *) _instance;
+    if (instance == nullptr) {
+        return false;
+    }
+    std::vector<float> window(env->GetArrayLength(_window));
+    env->GetFloatArrayRegion(_window, 0, (jsize) window.size(), window.data());
+    return instance->setWindow(window);
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanSpectrum_00024Companion_process(JNIEnv *env, jobject, jlong _instance, jobject samples, jint size,
+                                                                          jfloat alpha, jboolean reset, jfloatArray _spectrum, jfloatArray _peaks) {
+    auto *instance = (Vulkan::DSP::Spectrum *) _instance;
+    if (instance == nullptr || size <= 0 || env->GetDirectBufferCapacity(samples) < (jlong) S2B(size)) {
+        return false;
+    }
+    if (env->GetArrayLength(_spectrum) < size || (_peaks != nullptr && env->GetArrayLength(_peaks) < size)) {
+        return false;
+    }
+    auto *sampleBuffer = (const float *) env->GetDirectBufferAddress(samples);
+    auto *spectrum = env->GetFloatArrayElements(_spectrum, nullptr);
+    auto *peaks = _peaks != nullptr ? env->GetFloatArrayElements(_peaks, nullptr) : nullptr;
+    const bool success = instance->process(sampleBuffer, size, alpha, reset, spectrum, peaks);
+    env->ReleaseFloatArrayElements(_spectrum, spectrum, success ? 0 : JNI_ABORT);
+    if (peaks != nullptr) {
+        env->ReleaseFloatArrayElements(_peaks, peaks, success ? 0 : JNI_ABORT);
+    }
+    return success;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_hypermagik_spectrum_lib_gpu_VulkanSpectrum_00024Companion_delete(JNIEnv *env, jobject, jlong _instance) {
+    auto *instance = (Vulkan::DSP::Spectrum *) _instance;
+    delete instance;
+}
@@ -0,0 +1,147 @@
+#include "Allocator.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace Vulkan {
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    bool Allocator::Block::allocate(VkDeviceSize rangeSize, VkDeviceSize alignment, VkDeviceSize &offset) {
+        // First fit, the free space before the aligned offset stays free.
+        for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+            const VkDeviceSize start = it->first;
+            const VkDeviceSize end = it->first + it->second;
+            const VkDeviceSize aligned = alignUp(start, alignment);
+
+            if (aligned + rangeSize > end) {
+                continue;
+            }
+
+            freeRanges.erase(it);
+            if (aligned > start) {
+                freeRanges[start] = aligned - start;
+            }
+            if (aligned + rangeSize < end) {
+                freeRanges[aligned + rangeSize] = end - (aligned + rangeSize);
+            }
+
+            offset = aligned;
+            allocationCount++;
+            return true;
+        }
+
+        return false;
+    }
+
+    void Allocator::Block::free(VkDeviceSize offset, VkDeviceSize rangeSize) {
+        VkDeviceSize start = offset;
+        VkDeviceSize end = offset + rangeSize;
+
+        // Merge with the free ranges right after and right before.
+        auto next = freeRanges.lower_bound(start);
+        if (next != freeRanges.end() && next->first == end) {
+            end += next->second;
+            next = freeRanges.erase(next);
+        }
+        if (next != freeRanges.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == start) {
+                start = previous->first;
+                freeRanges.erase(previous);
+            }
+        }
+
+        freeRanges[start] = end - start;
+        allocationCount--;
+    }
+
+    bool Allocator::createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, Block **block) {
+        auto newBlock = std::make_unique<Block>(device, memoryTypeIndex, size);
+
+        const VkMemoryAllocateInfo allocateInfo = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .allocationSize = size,
+                .memoryTypeIndex = memoryTypeIndex,
+        };
+        VK_CALL(vkAllocateMemory, device, &allocateInfo, nullptr, newBlock->memory);
+
+        if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            VK_CALL(vkMapMemory, device, newBlock->memory, 0, VK_WHOLE_SIZE, 0, &newBlock->mapped);
+        }
+
+        newBlock->freeRanges[0] = size;
+
+        *block = newBlock.get();
+        blocks[memoryTypeIndex].emplace_back(std::move(newBlock));
+
+        return true;
+    }
+
+    bool Allocator::allocate(const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex, Allocation *allocation) {
+        VK_CHECK(allocation != nullptr && memoryTypeIndex < memoryProperties.memoryTypeCount);
+
+        const VkMemoryType &memoryType = memoryProperties.memoryTypes[memoryTypeIndex];
+        const bool hostVisible = memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        const bool hostCoherent = memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        // Ranges of non-coherent memory are padded to whole atoms, so flushing one buffer never touches another.
+        const VkDeviceSize atomSize = hostVisible && !hostCoherent ? deviceProperties.limits.nonCoherentAtomSize : 1;
+        const VkDeviceSize alignment = std::max(requirements.alignment, atomSize);
+        const VkDeviceSize size = alignUp(requirements.size, atomSize);
+
+        // Keep blocks small compared to the heap on devices with little memory.
+        const VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryType.heapIndex].size;
+        const VkDeviceSize typeBlockSize = alignUp(std::min(blockSize, heapSize / 8), atomSize);
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Block *block = nullptr;
+        VkDeviceSize offset = 0;
+
+        for (auto &candidate: blocks[memoryTypeIndex]) {
+            if (candidate->allocate(size, alignment, offset)) {
+                block = candidate.get();
+                break;
+            }
+        }
+
+        if (block == nullptr) {
+            VK_CHECK(createBlock(memoryTypeIndex, std::max(typeBlockSize, size), &block));
+            VK_CHECK(block->allocate(size, alignment, offset));
+            LOGD("Allocated %llu byte block of memory type %u, %zu blocks", (unsigned long long) block->size, memoryTypeIndex, blocks[memoryTypeIndex].size());
+        }
+
+        *allocation = {
+                .block = block,
+                .memory = block->memory,
+                .offset = offset,
+                .size = size,
+                .mapped = block->mapped != nullptr ? (char *) block->mapped + offset : nullptr,
+                .atomSize = atomSize,
+                .coherent = hostCoherent,
+        };
+
+        return true;
+    }
+
+    void Allocator::free(const Allocation &allocation) {
+        if (allocation.block == nullptr) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Block *block = allocation.block;
+        block->free(allocation.offset, allocation.size);
+
+        // Empty blocks are released, memory isn't held once all instances using it are gone.
+        if (block->allocationCount == 0) {
+            auto &typeBlocks = blocks[block->memoryTypeIndex];
+            typeBlocks.erase(std::find_if(typeBlocks.begin(), typeBlocks.end(), [block](const auto &b) { return b.get() == block; }));
+        }
+    }
+}
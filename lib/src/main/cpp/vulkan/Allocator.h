@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Wrappers.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace Vulkan {
+    // Hands out ranges of large device memory blocks instead of allocating memory for every buffer.
+    struct Allocator {
+        struct Block {
+            Block(VkDevice device, uint32_t memoryTypeIndex, VkDeviceSize size)
+                : memory(device), memoryTypeIndex(memoryTypeIndex), size(size) {}
+
+            VulkanDeviceMemory memory;
+            const uint32_t memoryTypeIndex;
+            const VkDeviceSize size;
+            // Host visible blocks stay mapped for their whole lifetime.
+            void *mapped = nullptr;
+
+            // Sizes of free ranges by offset, adjacent ranges are merged.
+            std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+            size_t allocationCount = 0;
+
+            bool allocate(VkDeviceSize rangeSize, VkDeviceSize alignment, VkDeviceSize &offset);
+            void free(VkDeviceSize offset, VkDeviceSize rangeSize);
+        };
+
+        struct Allocation {
+            Block *block = nullptr;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+            // Start of the range in host memory, null unless the memory is host visible.
+            void *mapped = nullptr;
+            // Flushed and invalidated ranges must be multiples of this, allocations are padded to it.
+            VkDeviceSize atomSize = 1;
+            // Coherent memory is never flushed or invalidated.
+            bool coherent = false;
+        };
+
+        Allocator(VkDevice device, const VkPhysicalDeviceProperties &deviceProperties, const VkPhysicalDeviceMemoryProperties &memoryProperties)
+            : device(device), deviceProperties(deviceProperties), memoryProperties(memoryProperties) {}
+
+        bool allocate(const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex, Allocation *allocation);
+        void free(const Allocation &allocation);
+
+    private:
+        // Larger requests get a block of their own.
+        static constexpr VkDeviceSize blockSize = 16 * 1024 * 1024;
+
+        bool createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, Block **block);
+
+        const VkDevice device;
+        const VkPhysicalDeviceProperties &deviceProperties;
+        const VkPhysicalDeviceMemoryProperties &memoryProperties;
+
+        // Instances on different threads create and destroy buffers at the same time.
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Block>> blocks[VK_MAX_MEMORY_TYPES];
+    };
+}
@@ -1,60 +1,101 @@
 #include "Buffer.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace Vulkan {
+    std::atomic<uint64_t> Buffer::nextGeneration = 1;
+
     std::unique_ptr<Buffer> Buffer::create(const Context *context, uint32_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
         auto buffer = std::make_unique<Buffer>(context, size);
         const bool success = buffer->initialize(usage, properties);
         return success ? std::move(buffer) : nullptr;
     }
 
+    std::unique_ptr<Buffer> Buffer::import(const Context *context, void *pointer, uint32_t size, VkBufferUsageFlags usage) {
+        auto buffer = std::make_unique<Buffer>(context, size);
+        const bool success = buffer->initialize(pointer, usage);
+        return success ? std::move(buffer) : nullptr;
+    }
+
+    Buffer::~Buffer() {
+        if (ownsAllocation) {
+            context->freeBuffer(allocation);
+        }
+    }
+
     bool Buffer::initialize(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
-        VK_CHECK(context->createBuffer(bufferSize, usage, properties, vkBuffer, vkMemory));
+        VK_CHECK(context->createBuffer(bufferSize, usage, properties, vkBuffer, &allocation));
+        ownsAllocation = true;
+        vkBufferInfo = {vkBuffer, 0, bufferSize};
+        return true;
+    }
+
+    bool Buffer::initialize(void *pointer, VkBufferUsageFlags usage) {
+        VK_CHECK(context->importBuffer(pointer, bufferSize, usage, vkBuffer, vkMemory));
+        // Imported memory is coherent and already mapped at the pointer.
+        allocation = {
+                .memory = vkMemory,
+                .size = bufferSize,
+                .mapped = pointer,
+                .coherent = true,
+        };
         vkBufferInfo = {vkBuffer, 0, bufferSize};
         return true;
     }
 
     bool Buffer::map(void **data, uint64_t offset, uint64_t size) const {
-        VK_CALL(vkMapMemory, context->device(), vkMemory, offset, size, 0, data);
+        // Blocks of host visible memory are mapped once, buffers hand out pointers into them.
+        VK_CHECK(allocation.mapped != nullptr && offset + size <= bufferSize);
+        *data = (char *) allocation.mapped + offset;
         return true;
     }
 
-    bool Buffer::flush(uint64_t offset, uint64_t size) const {
-        const VkMappedMemoryRange memoryRange = {
+    VkMappedMemoryRange Buffer::memoryRange(uint64_t offset, uint64_t size) const {
+        // Allocations of non-coherent memory start and end on atoms of nonCoherentAtomSize, so the rounded range stays inside them.
+        const VkDeviceSize atomSize = allocation.atomSize;
+        const VkDeviceSize start = (allocation.offset + offset) / atomSize * atomSize;
+        const VkDeviceSize end = std::min((allocation.offset + offset + size + atomSize - 1) / atomSize * atomSize, allocation.offset + allocation.size);
+        return {
                 .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
                 .pNext = nullptr,
-                .memory = vkMemory,
-                .offset = offset,
-                .size = size,
+                .memory = allocation.memory,
+                .offset = start,
+                .size = end - start,
         };
-        VK_CALL(vkFlushMappedMemoryRanges, context->device(), 1, &memoryRange);
+    }
+
+    bool Buffer::flush(uint64_t offset, uint64_t size) const {
+        if (allocation.coherent) {
+            return true;
+        }
+        const VkMappedMemoryRange range = memoryRange(offset, size);
+        VK_CALL(vkFlushMappedMemoryRanges, context->device(), 1, &range);
         return true;
     }
 
     bool Buffer::invalidate(uint64_t offset, uint64_t size) const {
-        const VkMappedMemoryRange memoryRange = {
-                .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-                .pNext = nullptr,
-                .memory = vkMemory,
-                .offset = offset,
-                .size = size,
-        };
-        VK_CALL(vkInvalidateMappedMemoryRanges, context->device(), 1, &memoryRange);
+        if (allocation.coherent) {
+            return true;
+        }
+        const VkMappedMemoryRange range = memoryRange(offset, size);
+        VK_CALL(vkInvalidateMappedMemoryRanges, context->device(), 1, &range);
         return true;
     }
 
     bool Buffer::copyFrom(const void *data, uint64_t offset, uint64_t size) const {
         void *bufferData = nullptr;
-        VK_CALL(vkMapMemory, context->device(), vkMemory, offset, size, 0, &bufferData);
+        VK_CHECK(map(&bufferData, offset, size));
         memcpy(bufferData, data, size);
-        vkUnmapMemory(context->device(), vkMemory);
+        VK_CHECK(flush(offset, size));
         return true;
     }
 
     bool Buffer::copyTo(void *data, uint64_t offset, uint64_t size) const {
         void *bufferData = nullptr;
-        VK_CALL(vkMapMemory, context->device(), vkMemory, offset, size, 0, &bufferData);
+        VK_CHECK(map(&bufferData, offset, size));
+        VK_CHECK(invalidate(offset, size));
         memcpy(data, bufferData, size);
-        vkUnmapMemory(context->device(), vkMemory);
         return true;
     }
-}
\ No newline at end of file
+}
@@ -1,21 +1,29 @@
 #pragma once
 
+#include "Allocator.h"
 #include "Context.h"
 #include "Utils.h"
 
+#include <atomic>
 #include <memory>
 
 namespace Vulkan {
     struct Buffer {
         static std::unique_ptr<Buffer> create(const Context *context, uint32_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+        // Buffer over existing host memory, which must outlive it, see Context::importBuffer.
+        static std::unique_ptr<Buffer> import(const Context *context, void *pointer, uint32_t size, VkBufferUsageFlags usage);
 
         Buffer(const Context *context, uint32_t bufferSize)
             : context(context)
             , bufferSize(bufferSize)
+            , bufferGeneration(nextGeneration++)
             , vkBuffer(context->device())
             , vkMemory(context->device()) {}
+        ~Buffer();
 
         uint32_t size() const { return bufferSize; }
+        // Unique to the buffer, unlike its address, which a buffer created after it was destroyed may reuse.
+        uint64_t generation() const { return bufferGeneration; }
 
         const VkBuffer handle() const { return vkBuffer; }
         const VkDescriptorBufferInfo &descriptor() const { return vkBufferInfo; }
@@ -29,12 +37,22 @@ namespace Vulkan {
 
     private:
         bool initialize(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+        bool initialize(void *pointer, VkBufferUsageFlags usage);
+
+        // Range of the device memory covering a range of the buffer, widened to whole atoms.
+        VkMappedMemoryRange memoryRange(uint64_t offset, uint64_t size) const;
 
         const Context *context;
         const uint32_t bufferSize;
+        const uint64_t bufferGeneration;
 
         VulkanBuffer vkBuffer;
+        // Memory of imported buffers, others use a range of a block of the allocator.
         VulkanDeviceMemory vkMemory;
+        Allocator::Allocation allocation;
+        bool ownsAllocation = false;
         VkDescriptorBufferInfo vkBufferInfo;
+
+        static std::atomic<uint64_t> nextGeneration;
     };
 }
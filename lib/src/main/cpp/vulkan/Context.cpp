@@ -2,16 +2,18 @@
 #include "Context.h"
 #include "Utils.h"
 
+#include <cstring>
 #include <vector>
 
 namespace Vulkan {
-    std::unique_ptr<Context> Context::create(bool enableDebug, AAssetManager *assetManager) {
+    std::unique_ptr<Context> Context::create(bool enableDebug, AAssetManager *assetManager, const char *pipelineCachePath) {
         auto vk = std::make_unique<Context>(assetManager);
         const bool success = vk->checkInstanceVersion() &&
                              vk->createInstance(enableDebug) &&
                              vk->pickPhysicalDeviceAndQueueFamily() &&
                              vk->createDevice() &&
-                             vk->createPools();
+                             vk->createPools() &&
+                             vk->createPipelineCache(pipelineCachePath);
         return success ? std::move(vk) : nullptr;
     }
 
@@ -103,11 +105,20 @@ namespace Vulkan {
 
             uint32_t computeQFI = 0;
             uint32_t queueCount = 0;
+            bool computeOnly = false;
 
+            // Prefer the family with the most queues up to the number used, then one without graphics,
+            // whose queues don't compete with rendering.
             for (uint32_t i = 0; i < queueFamilies.size(); i++) {
-                if ((queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 && queueFamilies[i].queueCount > queueCount) {
+                if ((queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) == 0) {
+                    continue;
+                }
+                const uint32_t familyQueueCount = std::min(maxQueueCount, queueFamilies[i].queueCount);
+                const bool familyComputeOnly = (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0;
+                if (familyQueueCount > queueCount || (familyQueueCount == queueCount && familyComputeOnly && !computeOnly)) {
                     computeQFI = i;
-                    queueCount = queueFamilies[i].queueCount;
+                    queueCount = familyQueueCount;
+                    computeOnly = familyComputeOnly;
                 }
             }
 
@@ -115,9 +126,17 @@ namespace Vulkan {
                 continue;
             }
 
+            // Devices without timeline semaphores run everything but the decimators, see supportsTimelineSemaphores.
+            bool needsExtension = false;
+            timelineSemaphores = checkTimelineSemaphoreSupport(device, needsExtension);
+
             vkPhysicalDevice = device;
+            timelineSemaphoreExtension = timelineSemaphores && needsExtension;
+            hostImportExtension = hasDeviceExtension(device, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+            pushDescriptorExtension = hasDeviceExtension(device, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
             queueFamilyIndex = computeQFI;
-            vkQueues.resize(std::min(maxQueueCount, queueCount), VK_NULL_HANDLE);
+            computeOnlyQueues = computeOnly;
+            vkQueues.resize(queueCount, VK_NULL_HANDLE);
             break;
         }
 
@@ -125,14 +144,94 @@ namespace Vulkan {
         vkGetPhysicalDeviceProperties(vkPhysicalDevice, &vkPhysicalDeviceProperties);
         vkGetPhysicalDeviceMemoryProperties(vkPhysicalDevice, &vkPhysicalDeviceMemoryProperties);
 
-        LOGD("Using physical device '%s' with %zu queues", vkPhysicalDeviceProperties.deviceName, vkQueues.size());
+        if (vkGetPhysicalDeviceProperties2 != nullptr) {
+            vkPhysicalDeviceExternalMemoryHostProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+            vkPhysicalDeviceSubgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+            vkPhysicalDeviceSubgroupProperties.pNext = hostImportExtension ? &vkPhysicalDeviceExternalMemoryHostProperties : nullptr;
+            VkPhysicalDeviceProperties2 properties = {
+                    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                    .pNext = &vkPhysicalDeviceSubgroupProperties,
+            };
+            vkGetPhysicalDeviceProperties2(vkPhysicalDevice, &properties);
+        }
+
+        LOGD("Using physical device '%s' with %zu %squeues of family %u", vkPhysicalDeviceProperties.deviceName, vkQueues.size(),
+             computeOnlyQueues ? "compute only " : "", queueFamilyIndex);
+        LOGD("Subgroup size %u, operations 0x%x", vkPhysicalDeviceSubgroupProperties.subgroupSize, vkPhysicalDeviceSubgroupProperties.supportedOperations);
+        LOGD("Host memory import %s, alignment %zu", hostImportExtension ? "supported" : "not supported", hostImportAlignment());
+        LOGD("Push descriptors %s", pushDescriptorExtension ? "supported" : "not supported");
+        LOGD("Timeline semaphores %s", timelineSemaphores ? "supported" : "not supported");
         return true;
     }
 
+    bool Context::supportsSubgroupShuffleRelative() const {
+        return (vkPhysicalDeviceSubgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 &&
+               (vkPhysicalDeviceSubgroupProperties.supportedOperations & VK_SUBGROUP_FEATURE_SHUFFLE_RELATIVE_BIT) != 0;
+    }
+
+    bool Context::checkTimelineSemaphoreSupport(VkPhysicalDevice device, bool &needsExtension) {
+        if (vkGetPhysicalDeviceFeatures2 == nullptr || vkWaitSemaphores == nullptr || vkGetSemaphoreCounterValue == nullptr) {
+            return false;
+        }
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device, &properties);
+
+        needsExtension = VK_VERSION_MINOR(properties.apiVersion) < 2;
+
+        if (needsExtension && !hasDeviceExtension(device, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+            return false;
+        }
+
+        VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+                .pNext = nullptr,
+                .timelineSemaphore = VK_FALSE,
+        };
+        VkPhysicalDeviceFeatures2 features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &timelineSemaphoreFeatures,
+                .features = {},
+        };
+        vkGetPhysicalDeviceFeatures2(device, &features);
+
+        return timelineSemaphoreFeatures.timelineSemaphore == VK_TRUE;
+    }
+
+    bool Context::hasDeviceExtension(VkPhysicalDevice device, const char *name) {
+        uint32_t numExtensions = 0;
+        VK_CALL(vkEnumerateDeviceExtensionProperties, device, nullptr, &numExtensions, nullptr);
+
+        std::vector<VkExtensionProperties> extensions(numExtensions);
+        VK_CALL(vkEnumerateDeviceExtensionProperties, device, nullptr, &numExtensions, extensions.data());
+
+        bool found = false;
+        for (const auto &extension: extensions) {
+            found = found || strcmp(extension.extensionName, name) == 0;
+        }
+        return found;
+    }
+
     bool Context::createDevice() {
         std::vector<const char *> deviceLayers = {};
         std::vector<const char *> deviceExtensions = {};
 
+        if (timelineSemaphoreExtension) {
+            deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        }
+        if (hostImportExtension) {
+            deviceExtensions.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+        }
+        if (pushDescriptorExtension) {
+            deviceExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+        }
+
+        VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+                .pNext = nullptr,
+                .timelineSemaphore = VK_TRUE,
+        };
+
         std::vector<float> queuePriorities(vkQueues.size(), 1.0f);
 
         const VkDeviceQueueCreateInfo queueCreateInfo = {
@@ -145,7 +244,7 @@ namespace Vulkan {
         };
         const VkDeviceCreateInfo deviceCreateInfo = {
                 .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-                .pNext = nullptr,
+                .pNext = timelineSemaphores ? &timelineSemaphoreFeatures : nullptr,
                 .flags = 0,
                 .queueCreateInfoCount = 1,
                 .pQueueCreateInfos = &queueCreateInfo,
@@ -158,59 +257,54 @@ namespace Vulkan {
 
         VK_CALL(vkCreateDevice, vkPhysicalDevice, &deviceCreateInfo, nullptr, vkDevice);
 
-        for (auto &vkQueue: vkQueues) {
-            vkGetDeviceQueue(vkDevice, queueFamilyIndex, 0, &vkQueue);
+        // Each queue of the family is a separate hardware queue, stages submitted to different queues may overlap.
+        for (uint32_t i = 0; i < vkQueues.size(); i++) {
+            vkGetDeviceQueue(vkDevice, queueFamilyIndex, i, &vkQueues[i]);
         }
 
         if (vkPhysicalDeviceProperties.limits.timestampPeriod != 0 && vkPhysicalDeviceProperties.limits.timestampComputeAndGraphics) {
             queryTimestampPeriod = vkPhysicalDeviceProperties.limits.timestampPeriod;
-
-            const VkQueryPoolCreateInfo queryPoolCreateInfo = {
-                    .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
-                    .pNext = nullptr,
-                    .queryType = VK_QUERY_TYPE_TIMESTAMP,
-                    .queryCount = 32,
-            };
-            vkCreateQueryPool(vkDevice, &queryPoolCreateInfo, nullptr, &vkQueryPool);
         }
 
         return true;
     }
 
     bool Context::createPools() {
-        vkDescriptorPool = VulkanDescriptorPool(vkDevice);
-
-        const std::vector<VkDescriptorPoolSize> poolSizes = {
-                {
-                        .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        .descriptorCount = 2 * 2 /* 2 x shifter x params+in/out */ +
-                                           2 * 16 * 4 /* 2 x 16 decimators x params+taps+in+out */,
-                },
+        allocator = std::make_unique<Allocator>(vkDevice, vkPhysicalDeviceProperties, vkPhysicalDeviceMemoryProperties);
+
+        return true;
+    }
+
+    bool Context::createDescriptorPool(VkDescriptorPool *descriptorPool) const {
+        // Room for sets of 8 buffers on average.
+        const VkDescriptorPoolSize poolSize = {
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = descriptorPoolBuffers,
         };
         const VkDescriptorPoolCreateInfo poolCreateInfo = {
                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
                 .pNext = nullptr,
                 .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-                .maxSets = 2 /* shifter */ +
-                           2 * 16 /* decimators */,
-                .poolSizeCount = (uint32_t) poolSizes.size(),
-                .pPoolSizes = poolSizes.data(),
+                .maxSets = descriptorPoolSets,
+                .poolSizeCount = 1,
+                .pPoolSizes = &poolSize,
         };
-        VK_CALL(vkCreateDescriptorPool, vkDevice, &poolCreateInfo, nullptr, vkDescriptorPool);
+        VK_CALL(vkCreateDescriptorPool, vkDevice, &poolCreateInfo, nullptr, descriptorPool);
 
-        vkCommandPool = VulkanCommandPool(vkDevice);
+        return true;
+    }
 
-        const VkCommandPoolCreateInfo commandPoolCreateInfo = {
-                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-                .pNext = nullptr,
-                .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-                .queueFamilyIndex = queueFamilyIndex,
-        };
-        VK_CALL(vkCreateCommandPool, vkDevice, &commandPoolCreateInfo, nullptr, vkCommandPool);
+    bool Context::createPipelineCache(const char *path) {
+        pipelines = std::make_unique<PipelineCache>(this);
+        VK_CHECK(pipelines->initialize(vkPhysicalDeviceProperties, path));
 
         return true;
     }
 
+    bool Context::savePipelineCache() const {
+        return pipelines->save();
+    }
+
     std::optional<uint32_t> Context::findMemoryType(uint32_t memoryTypeBits, VkFlags properties) const {
         for (uint32_t i = 0; i < vkPhysicalDeviceMemoryProperties.memoryTypeCount; i++) {
             if (memoryTypeBits & 1u) {
@@ -247,8 +341,8 @@ namespace Vulkan {
         return true;
     }
 
-    bool Context::createBuffer(size_t size, VkFlags bufferUsage, VkFlags memoryProperties, VkBuffer *buffer, VkDeviceMemory *memory) const {
-        if (buffer == nullptr || memory == nullptr) {
+    bool Context::createBuffer(size_t size, VkFlags bufferUsage, VkFlags memoryProperties, VkBuffer *buffer, Allocator::Allocation *allocation) const {
+        if (buffer == nullptr || allocation == nullptr) {
             return false;
         }
 
@@ -270,15 +364,72 @@ namespace Vulkan {
         const auto memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, memoryProperties);
         VK_CHECK(memoryTypeIndex.has_value());
 
+        VK_CHECK(allocator->allocate(memoryRequirements, memoryTypeIndex.value(), allocation));
+
+        VK_CALL(vkBindBufferMemory, vkDevice, *buffer, allocation->memory, allocation->offset);
+
+        return true;
+    }
+
+    void Context::freeBuffer(const Allocator::Allocation &allocation) const {
+        allocator->free(allocation);
+    }
+
+    bool Context::importBuffer(void *pointer, size_t size, VkFlags bufferUsage, VkBuffer *buffer, VkDeviceMemory *memory) const {
+        if (buffer == nullptr || memory == nullptr || !supportsHostImport()) {
+            return false;
+        }
+
+        const size_t alignment = hostImportAlignment();
+        VK_CHECK((uintptr_t) pointer % alignment == 0 && size % alignment == 0);
+
+        const VkExternalMemoryBufferCreateInfo externalCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+                .pNext = nullptr,
+                .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+        };
+        const VkBufferCreateInfo bufferCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .pNext = &externalCreateInfo,
+                .flags = 0,
+                .size = size,
+                .usage = bufferUsage,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = 0,
+                .pQueueFamilyIndices = nullptr,
+        };
+        VK_CALL(vkCreateBuffer, vkDevice, &bufferCreateInfo, nullptr, buffer);
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetBufferMemoryRequirements(vkDevice, *buffer, &memoryRequirements);
+
+        VkMemoryHostPointerPropertiesEXT pointerProperties = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT,
+                .pNext = nullptr,
+                .memoryTypeBits = 0,
+        };
+        VK_CALL(vkGetMemoryHostPointerPropertiesEXT, vkDevice, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, pointer, &pointerProperties);
+
+        // Imported memory is read by the GPU as it is, without host flushes.
+        const auto memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits & pointerProperties.memoryTypeBits,
+                                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(memoryTypeIndex.has_value());
+
+        const VkImportMemoryHostPointerInfoEXT importInfo = {
+                .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT,
+                .pNext = nullptr,
+                .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+                .pHostPointer = pointer,
+        };
         const VkMemoryAllocateInfo allocateInfo = {
                 .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-                .pNext = nullptr,
-                .allocationSize = memoryRequirements.size,
+                .pNext = &importInfo,
+                .allocationSize = size,
                 .memoryTypeIndex = memoryTypeIndex.value(),
         };
         VK_CALL(vkAllocateMemory, vkDevice, &allocateInfo, nullptr, memory);
 
-        vkBindBufferMemory(vkDevice, *buffer, *memory, 0);
+        VK_CALL(vkBindBufferMemory, vkDevice, *buffer, *memory, 0);
 
         return true;
     }
@@ -313,7 +464,60 @@ namespace Vulkan {
         return true;
     }
 
-    bool Context::createCommandBuffer(VkCommandBuffer *commandBuffer) const {
+    bool Context::createTimelineSemaphore(VkSemaphore *semaphore) const {
+        if (semaphore == nullptr || !timelineSemaphores) {
+            return false;
+        }
+
+        const VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+                .pNext = nullptr,
+                .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+                .initialValue = 0,
+        };
+        const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                .pNext = &semaphoreTypeCreateInfo,
+                .flags = 0,
+        };
+        VK_CALL(vkCreateSemaphore, vkDevice, &semaphoreCreateInfo, nullptr, semaphore);
+
+        return true;
+    }
+
+    bool Context::createCommandPool(VkCommandPool *commandPool) const {
+        if (commandPool == nullptr) {
+            return false;
+        }
+
+        const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                .queueFamilyIndex = queueFamilyIndex,
+        };
+        VK_CALL(vkCreateCommandPool, vkDevice, &commandPoolCreateInfo, nullptr, commandPool);
+
+        return true;
+    }
+
+    bool Context::createQueryPool(uint32_t queryCount, VkQueryPool *queryPool) const {
+        if (queryPool == nullptr) {
+            return false;
+        }
+
+        const VkQueryPoolCreateInfo queryPoolCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = queryCount,
+        };
+        VK_CALL(vkCreateQueryPool, vkDevice, &queryPoolCreateInfo, nullptr, queryPool);
+
+        return true;
+    }
+
+    bool Context::createCommandBuffer(VkCommandPool commandPool, VkCommandBuffer *commandBuffer) const {
         if (commandBuffer == nullptr) {
             return false;
         }
@@ -321,7 +525,7 @@ namespace Vulkan {
         const VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
                 .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
                 .pNext = nullptr,
-                .commandPool = vkCommandPool,
+                .commandPool = commandPool,
                 .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
                 .commandBufferCount = 1,
         };
@@ -330,6 +534,52 @@ namespace Vulkan {
         return true;
     }
 
+    bool Context::allocateDescriptorSet(VkDescriptorSetLayout layout, VkDescriptorSet *descriptorSet, VkDescriptorPool *descriptorPool) const {
+        VkDescriptorSetAllocateInfo allocateInfo = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .descriptorPool = VK_NULL_HANDLE,
+                .descriptorSetCount = 1,
+                .pSetLayouts = &layout,
+        };
+
+        std::lock_guard<std::mutex> lock(descriptorPoolMutex);
+
+        // Newest pools first, they are the most likely to have room left.
+        for (auto pool = vkDescriptorPools.rbegin(); pool != vkDescriptorPools.rend(); ++pool) {
+            allocateInfo.descriptorPool = **pool;
+            const auto result = vkAllocateDescriptorSets(vkDevice, &allocateInfo, descriptorSet);
+            if (result == VK_SUCCESS) {
+                *descriptorPool = allocateInfo.descriptorPool;
+                return true;
+            }
+            if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+                LOGE("vkAllocateDescriptorSets failed with %s at %s:%u", vkResultToString(result), __FILE__, __LINE__);
+                return false;
+            }
+        }
+
+        // All pools are full.
+        auto pool = std::make_unique<VulkanDescriptorPool>(vkDevice);
+        VK_CHECK(createDescriptorPool(*pool));
+        vkDescriptorPools.push_back(std::move(pool));
+
+        allocateInfo.descriptorPool = *vkDescriptorPools.back();
+        VK_CALL(vkAllocateDescriptorSets, vkDevice, &allocateInfo, descriptorSet);
+        *descriptorPool = allocateInfo.descriptorPool;
+
+        return true;
+    }
+
+    void Context::freeDescriptorSet(VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet) const {
+        std::lock_guard<std::mutex> lock(descriptorPoolMutex);
+
+        const auto result = vkFreeDescriptorSets(vkDevice, descriptorPool, 1, &descriptorSet);
+        if (result != VK_SUCCESS) {
+            LOGE("vkFreeDescriptorSets failed with %s at %s:%u", vkResultToString(result), __FILE__, __LINE__);
+        }
+    }
+
     void Context::addStageBarrier(VkCommandBuffer *commandBuffer, VkPipelineStageFlags stageFlags) {
         vkCmdPipelineBarrier(*commandBuffer, stageFlags, stageFlags, 0, 0, nullptr, 0, nullptr, 0, nullptr);
     }
@@ -362,14 +612,41 @@ namespace Vulkan {
                 .signalSemaphoreCount = 0,
                 .pSignalSemaphores = nullptr,
         };
-        VK_CALL(vkQueueSubmit, vkQueues.at(queueIndex), 1, &submitInfo, fence);
+        VK_CHECK(submit(queueIndex, 1, &submitInfo, fence));
+
+        return true;
+    }
 
+    bool Context::submit(size_t queueIndex, uint32_t submitCount, const VkSubmitInfo *submitInfo, VkFence fence) const {
+        std::lock_guard<std::mutex> lock(queueMutexes[queueIndex]);
+        VK_CALL(vkQueueSubmit, vkQueues.at(queueIndex), submitCount, submitInfo, fence);
         return true;
     }
 
     bool Context::queueWaitIdle(size_t queueIndex) const {
+        std::lock_guard<std::mutex> lock(queueMutexes[queueIndex]);
         VK_CALL(vkQueueWaitIdle, vkQueues.at(queueIndex));
         return true;
     }
+
+    bool Context::waitSemaphore(VkSemaphore semaphore, uint64_t value) const {
+        const VkSemaphoreWaitInfo waitInfo = {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .semaphoreCount = 1,
+                .pSemaphores = &semaphore,
+                .pValues = &value,
+        };
+        VK_CALL(vkWaitSemaphores, vkDevice, &waitInfo, -1ull);
+        return true;
+    }
+
+    bool Context::semaphoreReached(VkSemaphore semaphore, uint64_t value, bool &reached) const {
+        uint64_t counter = 0;
+        VK_CALL(vkGetSemaphoreCounterValue, vkDevice, semaphore, &counter);
+        reached = counter >= value;
+        return true;
+    }
 }
 
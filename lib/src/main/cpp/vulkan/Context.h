@@ -1,9 +1,13 @@
 #pragma once
 
+#include "Allocator.h"
+#include "PipelineCache.h"
 #include "Wrappers.h"
 
 #include <android/asset_manager.h>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <vector>
 #include <vulkan/vulkan_core.h>
@@ -11,29 +15,61 @@
 namespace Vulkan {
     struct Buffer;
 
+    // Shared by all DSP instances, which may run on different threads.
+    // Each instance records its commands into a command pool of its own and submits them through the context,
+    // which serializes submits to each queue and spreads instances over the queues.
     struct Context {
-        static std::unique_ptr<Context> create(bool enableDebug, AAssetManager *assetManager);
+        // Pipelines are cached in the file at pipelineCachePath between runs, if one is given.
+        static std::unique_ptr<Context> create(bool enableDebug, AAssetManager *assetManager, const char *pipelineCachePath);
 
         Context(AAssetManager *assetManager) : assetManager(assetManager) {}
 
         VkDevice device() const { return vkDevice; }
-        VkQueue queue(size_t index) const { return vkQueues.at(index); }
-        VkQueryPool queryPool() const { return vkQueryPool; }
-        VkCommandPool commandPool() const { return vkCommandPool; }
-        VkDescriptorPool descriptorPool() const { return vkDescriptorPool; }
+        PipelineCache *pipelineCache() const { return pipelines.get(); }
 
         size_t queueCount() const { return vkQueues.size(); }
+        // Queue for an instance that submits to a single queue, instances are assigned the queues in turn.
+        size_t assignQueue() const { return nextQueue++ % vkQueues.size(); }
         float timestampPeriod() const { return queryTimestampPeriod; }
+        uint32_t maxSharedMemorySize() const { return vkPhysicalDeviceProperties.limits.maxComputeSharedMemorySize; }
+        uint32_t subgroupSize() const { return vkPhysicalDeviceSubgroupProperties.subgroupSize; }
+        // Compute shaders can shuffle values up and down the subgroup.
+        bool supportsSubgroupShuffleRelative() const;
+        // Host memory can be imported into buffers, at pointers and sizes aligned to hostImportAlignment.
+        bool supportsHostImport() const { return hostImportExtension && vkGetMemoryHostPointerPropertiesEXT != nullptr; }
+        size_t hostImportAlignment() const { return vkPhysicalDeviceExternalMemoryHostProperties.minImportedHostPointerAlignment; }
+        // Pipelines push their buffer bindings into command buffers instead of allocating descriptor sets.
+        bool supportsPushDescriptors() const { return pushDescriptorExtension && vkCmdPushDescriptorSetKHR != nullptr; }
+        // Timeline semaphores order the stages of the decimators, which can't be created without them.
+        bool supportsTimelineSemaphores() const { return timelineSemaphores; }
 
         bool createShaderModule(const char *shaderFilePath, VkShaderModule *shaderModule) const;
-        bool createBuffer(size_t size, VkFlags bufferUsage, VkFlags memoryProperties, VkBuffer *buffer, VkDeviceMemory *memory) const;
+        // Buffer memory is a range of a larger block shared with other buffers, see Allocator.
+        bool createBuffer(size_t size, VkFlags bufferUsage, VkFlags memoryProperties, VkBuffer *buffer, Allocator::Allocation *allocation) const;
+        void freeBuffer(const Allocator::Allocation &allocation) const;
+        bool importBuffer(void *pointer, size_t size, VkFlags bufferUsage, VkBuffer *buffer, VkDeviceMemory *memory) const;
         bool createFence(VkFence *fence) const;
         bool createSemaphore(VkSemaphore *semaphore) const;
-        bool createCommandBuffer(VkCommandBuffer *commandBuffer) const;
+        bool createTimelineSemaphore(VkSemaphore *semaphore) const;
+        // Command pools are not thread safe, each instance creates its own and uses it from one thread at a time.
+        bool createCommandPool(VkCommandPool *commandPool) const;
+        bool createCommandBuffer(VkCommandPool commandPool, VkCommandBuffer *commandBuffer) const;
+        // Timestamp queries, each instance has its own so their indices don't collide.
+        bool createQueryPool(uint32_t queryCount, VkQueryPool *queryPool) const;
+        // Descriptor pools are added as the ones before fill up, sets are freed to the pool they were allocated from.
+        bool allocateDescriptorSet(VkDescriptorSetLayout layout, VkDescriptorSet *descriptorSet, VkDescriptorPool *descriptorPool) const;
+        void freeDescriptorSet(VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet) const;
 
         static bool beginCommandBuffer(VkCommandBuffer *commandBuffer);
         bool submitCommandBuffer(VkCommandBuffer commandBuffer, VkFence fence, size_t queueIndex) const;
+        // Submits to a queue, submits to the same queue from different threads are serialized.
+        bool submit(size_t queueIndex, uint32_t submitCount, const VkSubmitInfo *submitInfo, VkFence fence) const;
         bool queueWaitIdle(size_t queueIndex) const;
+        // Saves the pipelines created so far, to be called once an instance has created its pipelines.
+        bool savePipelineCache() const;
+        bool waitSemaphore(VkSemaphore semaphore, uint64_t value) const;
+        // Checks whether a timeline semaphore reached the value, without waiting.
+        bool semaphoreReached(VkSemaphore semaphore, uint64_t value, bool &reached) const;
 
         static void addStageBarrier(VkCommandBuffer *commandBuffer, VkPipelineStageFlags stageFlags);
 
@@ -43,6 +79,11 @@ namespace Vulkan {
         bool pickPhysicalDeviceAndQueueFamily();
         bool createDevice();
         bool createPools();
+        bool createPipelineCache(const char *path);
+        bool createDescriptorPool(VkDescriptorPool *descriptorPool) const;
+
+        static bool checkTimelineSemaphoreSupport(VkPhysicalDevice device, bool &needsExtension);
+        static bool hasDeviceExtension(VkPhysicalDevice device, const char *name);
 
         std::optional<uint32_t> findMemoryType(uint32_t memoryTypeBits, VkFlags properties) const;
 
@@ -54,15 +95,28 @@ namespace Vulkan {
         VkPhysicalDevice vkPhysicalDevice { VK_NULL_HANDLE };
         VkPhysicalDeviceProperties vkPhysicalDeviceProperties;
         VkPhysicalDeviceMemoryProperties vkPhysicalDeviceMemoryProperties;
+        VkPhysicalDeviceSubgroupProperties vkPhysicalDeviceSubgroupProperties = {};
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT vkPhysicalDeviceExternalMemoryHostProperties = {};
 
         uint32_t queueFamilyIndex = 0;
+        bool computeOnlyQueues = false;
+        bool timelineSemaphores = false;
+        bool timelineSemaphoreExtension = false;
+        bool hostImportExtension = false;
+        bool pushDescriptorExtension = false;
         float queryTimestampPeriod = 0.0f;
         static constexpr uint32_t maxQueueCount = 2;
 
         VulkanDevice vkDevice;
+        std::unique_ptr<Allocator> allocator;
         std::vector<VkQueue> vkQueues;
-        VkQueryPool vkQueryPool { VK_NULL_HANDLE };
-        VulkanDescriptorPool vkDescriptorPool { VK_NULL_HANDLE };
-        VulkanCommandPool vkCommandPool { VK_NULL_HANDLE };
+        mutable std::mutex queueMutexes[maxQueueCount];
+        mutable std::atomic<size_t> nextQueue = 0;
+        // Nothing is allocated from the descriptor pools when pipelines push their descriptors, so they are created on demand.
+        mutable std::vector<std::unique_ptr<VulkanDescriptorPool>> vkDescriptorPools;
+        mutable std::mutex descriptorPoolMutex;
+        static constexpr uint32_t descriptorPoolSets = 64;
+        static constexpr uint32_t descriptorPoolBuffers = 8 * descriptorPoolSets;
+        std::unique_ptr<PipelineCache> pipelines;
    };
 }
@@ -21,6 +21,7 @@ namespace Vulkan {
         VK_CHECK(vkCmdBindPipeline = (PFN_vkCmdBindPipeline) vkGetInstanceProcAddr(vkInstance, "vkCmdBindPipeline"));
         VK_CHECK(vkCmdCopyBuffer = (PFN_vkCmdCopyBuffer) vkGetInstanceProcAddr(vkInstance, "vkCmdCopyBuffer"));
         VK_CHECK(vkCmdDispatch = (PFN_vkCmdDispatch) vkGetInstanceProcAddr(vkInstance, "vkCmdDispatch"));
+        VK_CHECK(vkCmdDispatchIndirect = (PFN_vkCmdDispatchIndirect) vkGetInstanceProcAddr(vkInstance, "vkCmdDispatchIndirect"));
         VK_CHECK(vkCmdPipelineBarrier = (PFN_vkCmdPipelineBarrier) vkGetInstanceProcAddr(vkInstance, "vkCmdPipelineBarrier"));
         VK_CHECK(vkCmdPushConstants = (PFN_vkCmdPushConstants) vkGetInstanceProcAddr(vkInstance, "vkCmdPushConstants"));
         VK_CHECK(vkCmdResetQueryPool = (PFN_vkCmdResetQueryPool) vkGetInstanceProcAddr(vkInstance, "vkCmdResetQueryPool"));
@@ -32,6 +33,7 @@ namespace Vulkan {
         VK_CHECK(vkCreateDescriptorSetLayout = (PFN_vkCreateDescriptorSetLayout) vkGetInstanceProcAddr(vkInstance, "vkCreateDescriptorSetLayout"));
         VK_CHECK(vkCreateDevice = (PFN_vkCreateDevice) vkGetInstanceProcAddr(vkInstance, "vkCreateDevice"));
         VK_CHECK(vkCreateFence = (PFN_vkCreateFence) vkGetInstanceProcAddr(vkInstance, "vkCreateFence"));
+        VK_CHECK(vkCreatePipelineCache = (PFN_vkCreatePipelineCache) vkGetInstanceProcAddr(vkInstance, "vkCreatePipelineCache"));
         VK_CHECK(vkCreatePipelineLayout = (PFN_vkCreatePipelineLayout) vkGetInstanceProcAddr(vkInstance, "vkCreatePipelineLayout"));
         VK_CHECK(vkCreateQueryPool = (PFN_vkCreateQueryPool) vkGetInstanceProcAddr(vkInstance, "vkCreateQueryPool"));
         VK_CHECK(vkCreateSemaphore = (PFN_vkCreateSemaphore) vkGetInstanceProcAddr(vkInstance, "vkCreateSemaphore"));
@@ -45,11 +47,13 @@ namespace Vulkan {
         VK_CHECK(vkDestroyFence = (PFN_vkDestroyFence) vkGetInstanceProcAddr(vkInstance, "vkDestroyFence"));
         VK_CHECK(vkDestroyInstance = (PFN_vkDestroyInstance) vkGetInstanceProcAddr(vkInstance, "vkDestroyInstance"));
         VK_CHECK(vkDestroyPipeline = (PFN_vkDestroyPipeline) vkGetInstanceProcAddr(vkInstance, "vkDestroyPipeline"));
+        VK_CHECK(vkDestroyPipelineCache = (PFN_vkDestroyPipelineCache) vkGetInstanceProcAddr(vkInstance, "vkDestroyPipelineCache"));
         VK_CHECK(vkDestroyPipelineLayout = (PFN_vkDestroyPipelineLayout) vkGetInstanceProcAddr(vkInstance, "vkDestroyPipelineLayout"));
         VK_CHECK(vkDestroyQueryPool = (PFN_vkDestroyQueryPool) vkGetInstanceProcAddr(vkInstance, "vkDestroyQueryPool"));
         VK_CHECK(vkDestroySemaphore = (PFN_vkDestroySemaphore) vkGetInstanceProcAddr(vkInstance, "vkDestroySemaphore"));
         VK_CHECK(vkDestroyShaderModule = (PFN_vkDestroyShaderModule) vkGetInstanceProcAddr(vkInstance, "vkDestroyShaderModule"));
         VK_CHECK(vkEndCommandBuffer = (PFN_vkEndCommandBuffer) vkGetInstanceProcAddr(vkInstance, "vkEndCommandBuffer"));
+        VK_CHECK(vkEnumerateDeviceExtensionProperties = (PFN_vkEnumerateDeviceExtensionProperties) vkGetInstanceProcAddr(vkInstance, "vkEnumerateDeviceExtensionProperties"));
         VK_CHECK(vkEnumeratePhysicalDevices = (PFN_vkEnumeratePhysicalDevices) vkGetInstanceProcAddr(vkInstance, "vkEnumeratePhysicalDevices"));
         VK_CHECK(vkFlushMappedMemoryRanges = (PFN_vkFlushMappedMemoryRanges) vkGetInstanceProcAddr(vkInstance, "vkFlushMappedMemoryRanges"));
         VK_CHECK(vkFreeCommandBuffers = (PFN_vkFreeCommandBuffers) vkGetInstanceProcAddr(vkInstance, "vkFreeCommandBuffers"));
@@ -60,6 +64,7 @@ namespace Vulkan {
         VK_CHECK(vkGetPhysicalDeviceMemoryProperties = (PFN_vkGetPhysicalDeviceMemoryProperties) vkGetInstanceProcAddr(vkInstance, "vkGetPhysicalDeviceMemoryProperties"));
         VK_CHECK(vkGetPhysicalDeviceProperties = (PFN_vkGetPhysicalDeviceProperties) vkGetInstanceProcAddr(vkInstance, "vkGetPhysicalDeviceProperties"));
         VK_CHECK(vkGetPhysicalDeviceQueueFamilyProperties = (PFN_vkGetPhysicalDeviceQueueFamilyProperties) vkGetInstanceProcAddr(vkInstance, "vkGetPhysicalDeviceQueueFamilyProperties"));
+        VK_CHECK(vkGetPipelineCacheData = (PFN_vkGetPipelineCacheData) vkGetInstanceProcAddr(vkInstance, "vkGetPipelineCacheData"));
         VK_CHECK(vkGetQueryPoolResults = (PFN_vkGetQueryPoolResults) vkGetInstanceProcAddr(vkInstance, "vkGetQueryPoolResults"));
         VK_CHECK(vkInvalidateMappedMemoryRanges = (PFN_vkInvalidateMappedMemoryRanges) vkGetInstanceProcAddr(vkInstance, "vkInvalidateMappedMemoryRanges"));
         VK_CHECK(vkMapMemory = (PFN_vkMapMemory) vkGetInstanceProcAddr(vkInstance, "vkMapMemory"));
@@ -69,6 +74,22 @@ namespace Vulkan {
         VK_CHECK(vkUnmapMemory = (PFN_vkUnmapMemory) vkGetInstanceProcAddr(vkInstance, "vkUnmapMemory"));
         VK_CHECK(vkUpdateDescriptorSets = (PFN_vkUpdateDescriptorSets) vkGetInstanceProcAddr(vkInstance, "vkUpdateDescriptorSets"));
         VK_CHECK(vkWaitForFences = (PFN_vkWaitForFences) vkGetInstanceProcAddr(vkInstance, "vkWaitForFences"));
+
+        // Vulkan 1.1 and 1.2 functions, checked when picking the physical device.
+        vkGetPhysicalDeviceFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2) vkGetInstanceProcAddr(vkInstance, "vkGetPhysicalDeviceFeatures2");
+        vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2) vkGetInstanceProcAddr(vkInstance, "vkGetPhysicalDeviceProperties2");
+        vkWaitSemaphores = (PFN_vkWaitSemaphores) vkGetInstanceProcAddr(vkInstance, "vkWaitSemaphores");
+        if (vkWaitSemaphores == nullptr) {
+            vkWaitSemaphores = (PFN_vkWaitSemaphores) vkGetInstanceProcAddr(vkInstance, "vkWaitSemaphoresKHR");
+        }
+        vkGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValue) vkGetInstanceProcAddr(vkInstance, "vkGetSemaphoreCounterValue");
+        if (vkGetSemaphoreCounterValue == nullptr) {
+            vkGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValue) vkGetInstanceProcAddr(vkInstance, "vkGetSemaphoreCounterValueKHR");
+        }
+
+        // Optional extension functions, checked before use.
+        vkCmdPushDescriptorSetKHR = (PFN_vkCmdPushDescriptorSetKHR) vkGetInstanceProcAddr(vkInstance, "vkCmdPushDescriptorSetKHR");
+        vkGetMemoryHostPointerPropertiesEXT = (PFN_vkGetMemoryHostPointerPropertiesEXT) vkGetInstanceProcAddr(vkInstance, "vkGetMemoryHostPointerPropertiesEXT");
         return true;
     }
 }
@@ -82,8 +103,10 @@ PFN_vkCmdBindDescriptorSets vkCmdBindDescriptorSets;
 PFN_vkCmdBindPipeline vkCmdBindPipeline;
 PFN_vkCmdCopyBuffer vkCmdCopyBuffer;
 PFN_vkCmdDispatch vkCmdDispatch;
+PFN_vkCmdDispatchIndirect vkCmdDispatchIndirect;
 PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier;
 PFN_vkCmdPushConstants vkCmdPushConstants;
+PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR;
 PFN_vkCmdResetQueryPool vkCmdResetQueryPool;
 PFN_vkCmdWriteTimestamp vkCmdWriteTimestamp;
 PFN_vkCreateBuffer vkCreateBuffer;
@@ -94,6 +117,7 @@ PFN_vkCreateDescriptorSetLayout vkCreateDescriptorSetLayout;
 PFN_vkCreateDevice vkCreateDevice;
 PFN_vkCreateFence vkCreateFence;
 PFN_vkCreateInstance vkCreateInstance;
+PFN_vkCreatePipelineCache vkCreatePipelineCache;
 PFN_vkCreatePipelineLayout vkCreatePipelineLayout;
 PFN_vkCreateQueryPool vkCreateQueryPool;
 PFN_vkCreateSemaphore vkCreateSemaphore;
@@ -107,11 +131,13 @@ PFN_vkDestroyEvent vkDestroyEvent;
 PFN_vkDestroyFence vkDestroyFence;
 PFN_vkDestroyInstance vkDestroyInstance;
 PFN_vkDestroyPipeline vkDestroyPipeline;
+PFN_vkDestroyPipelineCache vkDestroyPipelineCache;
 PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout;
 PFN_vkDestroyQueryPool vkDestroyQueryPool;
 PFN_vkDestroySemaphore vkDestroySemaphore;
 PFN_vkDestroyShaderModule vkDestroyShaderModule;
 PFN_vkEndCommandBuffer vkEndCommandBuffer;
+PFN_vkEnumerateDeviceExtensionProperties vkEnumerateDeviceExtensionProperties;
 PFN_vkEnumerateInstanceVersion vkEnumerateInstanceVersion;
 PFN_vkEnumeratePhysicalDevices vkEnumeratePhysicalDevices;
 PFN_vkFlushMappedMemoryRanges vkFlushMappedMemoryRanges;
@@ -120,11 +146,16 @@ PFN_vkFreeDescriptorSets vkFreeDescriptorSets;
 PFN_vkFreeMemory vkFreeMemory;
 PFN_vkGetBufferMemoryRequirements vkGetBufferMemoryRequirements;
 PFN_vkGetDeviceQueue vkGetDeviceQueue;
+PFN_vkGetMemoryHostPointerPropertiesEXT vkGetMemoryHostPointerPropertiesEXT;
 PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+PFN_vkGetPhysicalDeviceFeatures2 vkGetPhysicalDeviceFeatures2;
 PFN_vkGetPhysicalDeviceMemoryProperties vkGetPhysicalDeviceMemoryProperties;
 PFN_vkGetPhysicalDeviceProperties vkGetPhysicalDeviceProperties;
+PFN_vkGetPhysicalDeviceProperties2 vkGetPhysicalDeviceProperties2;
 PFN_vkGetPhysicalDeviceQueueFamilyProperties vkGetPhysicalDeviceQueueFamilyProperties;
+PFN_vkGetPipelineCacheData vkGetPipelineCacheData;
 PFN_vkGetQueryPoolResults vkGetQueryPoolResults;
+PFN_vkGetSemaphoreCounterValue vkGetSemaphoreCounterValue;
 PFN_vkInvalidateMappedMemoryRanges vkInvalidateMappedMemoryRanges;
 PFN_vkMapMemory vkMapMemory;
 PFN_vkQueueSubmit vkQueueSubmit;
@@ -133,3 +164,4 @@ PFN_vkResetFences vkResetFences;
 PFN_vkUnmapMemory vkUnmapMemory;
 PFN_vkUpdateDescriptorSets vkUpdateDescriptorSets;
 PFN_vkWaitForFences vkWaitForFences;
+PFN_vkWaitSemaphores vkWaitSemaphores;
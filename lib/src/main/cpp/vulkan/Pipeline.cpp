@@ -1,79 +1,93 @@
+#include "Buffer.h"
 #include "Pipeline.h"
 #include "Utils.h"
 
 namespace Vulkan {
     bool Pipeline::createDescriptorSet(const std::vector<VkDescriptorSetLayoutBinding> &layoutBinding) {
-        const VkDescriptorSetLayoutCreateInfo createInfo = {
-                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-                .pNext = nullptr,
-                .flags = 0,
-                .bindingCount = (uint32_t) layoutBinding.size(),
-                .pBindings = layoutBinding.data(),
-        };
-        VK_CALL(vkCreateDescriptorSetLayout, context->device(), &createInfo, nullptr, vkDescriptorSetLayout);
+        const VkDescriptorSetLayoutCreateFlags flags = pushDescriptors ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0;
+        VK_CHECK(context->pipelineCache()->getDescriptorSetLayout(layoutBinding, flags, &vkDescriptorSetLayout));
 
-        const VkDescriptorSetAllocateInfo allocateInfo = {
-                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-                .pNext = nullptr,
-                .descriptorPool = context->descriptorPool(),
-                .descriptorSetCount = 1,
-                .pSetLayouts = vkDescriptorSetLayout,
-        };
-        VK_CALL(vkAllocateDescriptorSets, context->device(), &allocateInfo, &vkDescriptorSet);
+        bufferInfos.resize(layoutBinding.size(), {VK_NULL_HANDLE, 0, VK_WHOLE_SIZE});
+
+        if (pushDescriptors) {
+            return true;
+        }
+
+        VK_CHECK(context->allocateDescriptorSet(vkDescriptorSetLayout, &vkDescriptorSet, &vkDescriptorPool));
 
         return true;
     }
 
-    bool Pipeline::createComputePipeline(const char *shader, const VkPushConstantRange *pushConstants) {
-        VulkanShaderModule shaderModule(context->device());
-        VK_CHECK(context->createShaderModule(shader, shaderModule));
+    bool Pipeline::createComputePipeline(const char *shader, const VkPushConstantRange *pushConstants, const std::vector<uint32_t> &constants) {
+        VK_CHECK(context->pipelineCache()->getPipelineLayout(vkDescriptorSetLayout, pushConstants, &vkPipelineLayout));
 
-        const VkPipelineLayoutCreateInfo layoutCreateInfo = {
-                .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-                .pNext = nullptr,
-                .flags = 0,
-                .setLayoutCount = 1,
-                .pSetLayouts = vkDescriptorSetLayout,
-                .pushConstantRangeCount = pushConstants == nullptr ? 0 : 1u,
-                .pPushConstantRanges = pushConstants
-        };
-        VK_CALL(vkCreatePipelineLayout, context->device(), &layoutCreateInfo, nullptr, vkPipelineLayout);
+        std::vector<uint32_t> specializationData = {workGroupSize};
+        specializationData.insert(specializationData.end(), constants.begin(), constants.end());
 
-        const uint32_t specializationData[] = {workGroupSize};
-        const std::vector<VkSpecializationMapEntry> specializationMap = {{0, 0, sizeof(uint32_t)}};
+        VK_CHECK(context->pipelineCache()->getComputePipeline(shader, vkPipelineLayout, specializationData, &vkPipeline));
 
-        const VkSpecializationInfo specializationInfo = {
-                .mapEntryCount = (uint32_t) specializationMap.size(),
-                .pMapEntries = specializationMap.data(),
-                .dataSize = sizeof(specializationData),
-                .pData = specializationData,
-        };
-        const VkComputePipelineCreateInfo pipelineCreateInfo = {
-                .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        return true;
+    }
+
+    VkWriteDescriptorSet Pipeline::writeDescriptorSet(uint32_t binding) const {
+        return {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
                 .pNext = nullptr,
-                .flags = 0,
-                .stage = {
-                        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-                        .pNext = nullptr,
-                        .flags = 0,
-                        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
-                        .module = shaderModule,
-                        .pName = "main",
-                        .pSpecializationInfo = &specializationInfo,
-                },
-                .layout = vkPipelineLayout,
-                .basePipelineHandle = 0,
-                .basePipelineIndex = 0,
+                .dstSet = vkDescriptorSet,
+                .dstBinding = binding,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pImageInfo = nullptr,
+                .pBufferInfo = &bufferInfos[binding],
+                .pTexelBufferView = nullptr,
         };
-        VK_CALL(vkCreateComputePipelines, context->device(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, vkPipeline);
+    }
+
+    bool Pipeline::updateDescriptorSets(const std::vector<const Buffer *> &buffers) {
+        VK_CHECK(buffers.size() == bufferInfos.size());
 
+        std::vector<VkWriteDescriptorSet> descriptorSets;
+        for (uint32_t i = 0; i < buffers.size(); i++) {
+            bufferInfos[i] = buffers[i]->descriptor();
+            descriptorSets.push_back(writeDescriptorSet(i));
+        }
+
+        // Pushed descriptors are only written when recording commands.
+        if (!pushDescriptors) {
+            vkUpdateDescriptorSets(context->device(), (uint32_t) descriptorSets.size(), descriptorSets.data(), 0, nullptr);
+        }
+        return true;
+    }
+
+    bool Pipeline::updateDescriptorSet(uint32_t binding, const Buffer *buffer) {
+        VK_CHECK(binding < bufferInfos.size());
+
+        bufferInfos[binding] = buffer->descriptor();
+
+        if (!pushDescriptors) {
+            const VkWriteDescriptorSet descriptorSet = writeDescriptorSet(binding);
+            vkUpdateDescriptorSets(context->device(), 1, &descriptorSet, 0, nullptr);
+        }
         return true;
     }
 
+    void Pipeline::bindDescriptorSet(VkCommandBuffer commandBuffer) const {
+        if (!pushDescriptors) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipelineLayout, 0, 1, &vkDescriptorSet, 0, nullptr);
+            return;
+        }
+
+        std::vector<VkWriteDescriptorSet> descriptorSets;
+        for (uint32_t i = 0; i < bufferInfos.size(); i++) {
+            descriptorSets.push_back(writeDescriptorSet(i));
+        }
+        vkCmdPushDescriptorSetKHR(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipelineLayout, 0, (uint32_t) descriptorSets.size(), descriptorSets.data());
+    }
+
     Pipeline::~Pipeline() {
-        const auto result = vkFreeDescriptorSets(context->device(), context->descriptorPool(), 1, &vkDescriptorSet);
-        if (result != VK_SUCCESS) {
-            LOGE("vkFreeDescriptorSets failed with %s at %s:%u", vkResultToString(result), __FILE__, __LINE__);
+        if (vkDescriptorSet != VK_NULL_HANDLE) {
+            context->freeDescriptorSet(vkDescriptorPool, vkDescriptorSet);
         }
     }
 }
@@ -10,21 +10,35 @@ namespace Vulkan {
         Pipeline(const Context *context, uint32_t workGroupSize)
             : context(context)
             , workGroupSize(workGroupSize)
-            , vkDescriptorSetLayout(context->device())
-            , vkPipelineLayout(context->device())
-            , vkPipeline(context->device()) {}
+            , pushDescriptors(context->supportsPushDescriptors()) {}
         ~Pipeline();
 
+        // Bindings are numbered from 0, no descriptor set is allocated when descriptors are pushed.
         bool createDescriptorSet(const std::vector<VkDescriptorSetLayoutBinding> &layoutBinding);
-        bool createComputePipeline(const char *shader, const VkPushConstantRange *pushConstants);
+        // Specialization constant 0 is the work group size, additional constants start at 1.
+        bool createComputePipeline(const char *shader, const VkPushConstantRange *pushConstants, const std::vector<uint32_t> &constants = {});
+        // Points storage buffer bindings 0 to n - 1 at the given buffers.
+        bool updateDescriptorSets(const std::vector<const Buffer *> &buffers);
+        // Points a storage buffer binding at another buffer, command buffers using the descriptor set must be recorded again.
+        bool updateDescriptorSet(uint32_t binding, const Buffer *buffer);
+        // Binds the descriptor set, or pushes the bound buffers into the command buffer.
+        void bindDescriptorSet(VkCommandBuffer commandBuffer) const;
 
         const Context * const context;
         const uint32_t workGroupSize;
+        const bool pushDescriptors;
 
-        VulkanDescriptorSetLayout vkDescriptorSetLayout;
+        // Layouts and pipelines are owned by the context's pipeline cache and shared with other instances.
+        VkDescriptorSetLayout vkDescriptorSetLayout = VK_NULL_HANDLE;
         VkDescriptorSet vkDescriptorSet = VK_NULL_HANDLE;
+        VkDescriptorPool vkDescriptorPool = VK_NULL_HANDLE;
+        // Buffers of the bindings, kept to push them when recording commands.
+        std::vector<VkDescriptorBufferInfo> bufferInfos;
 
-        VulkanPipelineLayout vkPipelineLayout;
-        VulkanPipeline vkPipeline;
+        VkPipelineLayout vkPipelineLayout = VK_NULL_HANDLE;
+        VkPipeline vkPipeline = VK_NULL_HANDLE;
+
+    private:
+        VkWriteDescriptorSet writeDescriptorSet(uint32_t binding) const;
     };
 }
@@ -0,0 +1,229 @@
+#include "Context.h"
+#include "PipelineCache.h"
+#include "Utils.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Vulkan {
+    // Header at the start of the cache data, see VkPipelineCacheHeaderVersionOne.
+    struct CacheHeader {
+        uint32_t headerSize;
+        uint32_t headerVersion;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+    };
+
+    bool PipelineCache::initialize(const VkPhysicalDeviceProperties &properties, const char *path) {
+        cachePath = path != nullptr ? path : "";
+
+        std::vector<uint8_t> data;
+        if (!cachePath.empty() && !loadCacheData(properties, data)) {
+            data.clear();
+        }
+
+        cacheSize = data.size();
+        vkPipelineCache = VulkanPipelineCache(context->device());
+
+        const VkPipelineCacheCreateInfo createInfo = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .initialDataSize = data.size(),
+                .pInitialData = data.data(),
+        };
+        VK_CALL(vkCreatePipelineCache, context->device(), &createInfo, nullptr, vkPipelineCache);
+
+        LOGD("Pipeline cache loaded with %zu bytes", data.size());
+
+        return true;
+    }
+
+    bool PipelineCache::loadCacheData(const VkPhysicalDeviceProperties &properties, std::vector<uint8_t> &data) const {
+        FILE *file = fopen(cachePath.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+
+        fseek(file, 0, SEEK_END);
+        const long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        data.resize(size > 0 ? size : 0);
+        const size_t read = fread(data.data(), 1, data.size(), file);
+        fclose(file);
+
+        VK_CHECK(read == data.size() && data.size() >= sizeof(CacheHeader));
+
+        // Drivers should ignore data of another device or driver version, but some don't check.
+        CacheHeader header;
+        memcpy(&header, data.data(), sizeof(header));
+
+        VK_CHECK(header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE);
+        VK_CHECK(header.vendorID == properties.vendorID && header.deviceID == properties.deviceID);
+        VK_CHECK(memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+
+        return true;
+    }
+
+    bool PipelineCache::save() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (cachePath.empty() || !cacheChanged) {
+            return true;
+        }
+
+        size_t size = 0;
+        VK_CALL(vkGetPipelineCacheData, context->device(), vkPipelineCache, &size, nullptr);
+
+        // Pipelines were all found in the cache loaded at startup.
+        if (size == cacheSize) {
+            cacheChanged = false;
+            return true;
+        }
+
+        std::vector<uint8_t> data(size);
+        VK_CALL(vkGetPipelineCacheData, context->device(), vkPipelineCache, &size, data.data());
+
+        // Written next to the cache and renamed over it, a cache cut short by the process being killed is never read.
+        const std::string tempPath = cachePath + ".tmp";
+
+        FILE *file = fopen(tempPath.c_str(), "wb");
+        VK_CHECK(file != nullptr);
+        const size_t written = fwrite(data.data(), 1, size, file);
+        const bool closed = fclose(file) == 0;
+        VK_CHECK(written == size && closed);
+        VK_CHECK(rename(tempPath.c_str(), cachePath.c_str()) == 0);
+
+        cacheSize = size;
+        cacheChanged = false;
+
+        LOGD("Pipeline cache saved with %zu bytes", size);
+
+        return true;
+    }
+
+    bool PipelineCache::getShaderModule(const char *shader, VkShaderModule *module) {
+        auto it = shaderModules.find(shader);
+        if (it == shaderModules.end()) {
+            VulkanShaderModule shaderModule(context->device());
+            VK_CHECK(context->createShaderModule(shader, shaderModule));
+            it = shaderModules.emplace(shader, std::move(shaderModule)).first;
+        }
+
+        *module = it->second;
+        return true;
+    }
+
+    bool PipelineCache::getDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings, VkDescriptorSetLayoutCreateFlags flags,
+                                               VkDescriptorSetLayout *layout) {
+        std::vector<uint64_t> key = {flags};
+        for (const auto &binding: bindings) {
+            key.insert(key.end(), {binding.binding, (uint64_t) binding.descriptorType, binding.descriptorCount, binding.stageFlags});
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = setLayouts.find(key);
+        if (it == setLayouts.end()) {
+            VulkanDescriptorSetLayout setLayout(context->device());
+
+            const VkDescriptorSetLayoutCreateInfo createInfo = {
+                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = flags,
+                    .bindingCount = (uint32_t) bindings.size(),
+                    .pBindings = bindings.data(),
+            };
+            VK_CALL(vkCreateDescriptorSetLayout, context->device(), &createInfo, nullptr, setLayout);
+
+            it = setLayouts.emplace(key, std::move(setLayout)).first;
+        }
+
+        *layout = it->second;
+        return true;
+    }
+
+    bool PipelineCache::getPipelineLayout(VkDescriptorSetLayout setLayout, const VkPushConstantRange *pushConstants, VkPipelineLayout *layout) {
+        std::vector<uint64_t> key = {(uint64_t) setLayout};
+        if (pushConstants != nullptr) {
+            key.insert(key.end(), {pushConstants->stageFlags, pushConstants->offset, pushConstants->size});
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = pipelineLayouts.find(key);
+        if (it == pipelineLayouts.end()) {
+            VulkanPipelineLayout pipelineLayout(context->device());
+
+            const VkPipelineLayoutCreateInfo createInfo = {
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .setLayoutCount = 1,
+                    .pSetLayouts = &setLayout,
+                    .pushConstantRangeCount = pushConstants == nullptr ? 0 : 1u,
+                    .pPushConstantRanges = pushConstants
+            };
+            VK_CALL(vkCreatePipelineLayout, context->device(), &createInfo, nullptr, pipelineLayout);
+
+            it = pipelineLayouts.emplace(key, std::move(pipelineLayout)).first;
+        }
+
+        *layout = it->second;
+        return true;
+    }
+
+    bool PipelineCache::getComputePipeline(const char *shader, VkPipelineLayout layout, const std::vector<uint32_t> &specializationData, VkPipeline *pipeline) {
+        std::vector<uint64_t> constants = {(uint64_t) layout};
+        constants.insert(constants.end(), specializationData.begin(), specializationData.end());
+        const auto key = std::make_pair(std::string(shader), constants);
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = pipelines.find(key);
+        if (it == pipelines.end()) {
+            VkShaderModule shaderModule;
+            VK_CHECK(getShaderModule(shader, &shaderModule));
+
+            std::vector<VkSpecializationMapEntry> specializationMap;
+            for (uint32_t i = 0; i < specializationData.size(); i++) {
+                specializationMap.push_back({i, i * (uint32_t) sizeof(uint32_t), sizeof(uint32_t)});
+            }
+
+            const VkSpecializationInfo specializationInfo = {
+                    .mapEntryCount = (uint32_t) specializationMap.size(),
+                    .pMapEntries = specializationMap.data(),
+                    .dataSize = specializationData.size() * sizeof(uint32_t),
+                    .pData = specializationData.data(),
+            };
+            const VkComputePipelineCreateInfo createInfo = {
+                    .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .stage = {
+                            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                            .pNext = nullptr,
+                            .flags = 0,
+                            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                            .module = shaderModule,
+                            .pName = "main",
+                            .pSpecializationInfo = &specializationInfo,
+                    },
+                    .layout = layout,
+                    .basePipelineHandle = 0,
+                    .basePipelineIndex = 0,
+            };
+
+            VulkanPipeline computePipeline(context->device());
+            VK_CALL(vkCreateComputePipelines, context->device(), vkPipelineCache, 1, &createInfo, nullptr, computePipeline);
+
+            it = pipelines.emplace(key, std::move(computePipeline)).first;
+            cacheChanged = true;
+        }
+
+        *pipeline = it->second;
+        return true;
+    }
+}
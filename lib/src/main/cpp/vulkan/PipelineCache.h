@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Wrappers.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace Vulkan {
+    struct Context;
+
+    // Shader modules, layouts and pipelines shared by all pipelines of a context, keyed by what they are created from.
+    // Pipelines are created through a VkPipelineCache saved to disk, so those seen in an earlier run come from the cache.
+    struct PipelineCache {
+        PipelineCache(const Context *context) : context(context) {}
+
+        // Loads the cache saved at path by an earlier run on the same device, no cache is saved without a path.
+        bool initialize(const VkPhysicalDeviceProperties &properties, const char *path);
+
+        bool getDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings, VkDescriptorSetLayoutCreateFlags flags,
+                                    VkDescriptorSetLayout *layout);
+        bool getPipelineLayout(VkDescriptorSetLayout setLayout, const VkPushConstantRange *pushConstants, VkPipelineLayout *layout);
+        // Specialization data holds a 32-bit value for each constant, starting at constant 0.
+        bool getComputePipeline(const char *shader, VkPipelineLayout layout, const std::vector<uint32_t> &specializationData, VkPipeline *pipeline);
+
+        // Writes the cache to disk if pipelines were created since it was last written.
+        bool save();
+
+    private:
+        bool getShaderModule(const char *shader, VkShaderModule *module);
+        bool loadCacheData(const VkPhysicalDeviceProperties &properties, std::vector<uint8_t> &data) const;
+
+        const Context * const context;
+
+        std::string cachePath;
+        // Size of the data last loaded or saved, drivers only add to it.
+        size_t cacheSize = 0;
+        bool cacheChanged = false;
+
+        // Pipelines are created by instances on different threads.
+        std::mutex mutex;
+
+        VulkanPipelineCache vkPipelineCache { VK_NULL_HANDLE };
+
+        std::map<std::string, VulkanShaderModule> shaderModules;
+        std::map<std::vector<uint64_t>, VulkanDescriptorSetLayout> setLayouts;
+        std::map<std::vector<uint64_t>, VulkanPipelineLayout> pipelineLayouts;
+        std::map<std::pair<std::string, std::vector<uint64_t>>, VulkanPipeline> pipelines;
+    };
+}
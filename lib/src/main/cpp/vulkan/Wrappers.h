@@ -89,6 +89,7 @@ VULKAN_RAII_OBJECT_FROM_DEVICE(DeviceMemory, vkFreeMemory);
 VULKAN_RAII_OBJECT_FROM_DEVICE(Event, vkDestroyEvent);
 VULKAN_RAII_OBJECT_FROM_DEVICE(Fence, vkDestroyFence);
 VULKAN_RAII_OBJECT_FROM_DEVICE(Pipeline, vkDestroyPipeline);
+VULKAN_RAII_OBJECT_FROM_DEVICE(PipelineCache, vkDestroyPipelineCache);
 VULKAN_RAII_OBJECT_FROM_DEVICE(PipelineLayout, vkDestroyPipelineLayout);
 VULKAN_RAII_OBJECT_FROM_DEVICE(QueryPool, vkDestroyQueryPool);
 VULKAN_RAII_OBJECT_FROM_DEVICE(Semaphore, vkDestroySemaphore);
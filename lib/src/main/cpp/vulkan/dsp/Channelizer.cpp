@@ -0,0 +1,208 @@
+#include "Channelizer.h"
+#include "vulkan/Utils.h"
+
+#include <algorithm>
+
+namespace Vulkan::DSP {
+    static uint32_t groupCount(size_t count, size_t groupSize) {
+        return (count + groupSize - 1) / groupSize;
+    }
+
+    std::unique_ptr<Channelizer> Channelizer::create(Context *context, std::vector<float> &&taps, size_t branches, size_t decimation, size_t depth) {
+        if (context == nullptr || depth < MIN_DEPTH || depth > MAX_DEPTH) {
+            return nullptr;
+        }
+        auto processor = std::make_unique<Channelizer>(context, branches, decimation, depth);
+        const bool success = processor->initialize(taps);
+        return success ? std::move(processor) : nullptr;
+    }
+
+    bool Channelizer::initialize(std::vector<float> &taps) {
+        // The FFT across the branches is radix 2 and runs in shared memory.
+        VK_CHECK(branches >= 2 && branches <= MAX_BRANCHES && (branches & (branches - 1)) == 0);
+        VK_CHECK(S2B(branches) <= context->maxSharedMemorySize());
+        // Critically sampled up to oversampled by MAX_OVERSAMPLING.
+        VK_CHECK(decimation > 0 && decimation <= branches && decimation * MAX_OVERSAMPLING >= branches);
+        VK_CHECK(!taps.empty());
+
+        // Pad the prototype filter to a whole number of taps per branch.
+        tapsPerBranch = (taps.size() + branches - 1) / branches;
+        taps.resize(branches * tapsPerBranch, 0.0f);
+
+        history = taps.size() - 1;
+        outputSize = MAX_SAMPLE_ARRAY_SIZE / decimation + 1;
+
+        // The input buffer starts uninitialized, so the first output waits for a full span of the filter.
+        position = history;
+        rotation = 0;
+
+        tapsBuffer = Buffer::create(
+                context, F2B(taps.size()),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(tapsBuffer != nullptr);
+        VK_CHECK(tapsBuffer->copyFrom(taps.data(), 0, F2B(taps.size())));
+
+        // History and a full block.
+        inputBuffer = Buffer::create(
+                context, S2B(history + MAX_SAMPLE_ARRAY_SIZE),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK(inputBuffer != nullptr);
+
+        const uint32_t strides[2] = {0, 0};
+
+        for (size_t i = 0; i < numBuffers; i++) {
+            paramsBuffers[i] = Buffer::create(
+                    context, sizeof(Params),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK(paramsBuffers[i] != nullptr);
+
+            dispatchBuffers[i] = Buffer::create(
+                    context, sizeof(Dispatch),
+                    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK(dispatchBuffers[i] != nullptr);
+
+            stagingBuffers[i] = Buffer::create(
+                    context, S2B(MAX_SAMPLE_ARRAY_SIZE),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            VK_CHECK(stagingBuffers[i] != nullptr);
+
+            outputBuffers[i] = Buffer::create(
+                    context, S2B(branches * outputSize),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK(outputBuffers[i] != nullptr);
+
+            VK_CHECK(paramsBuffers[i]->map((void **) &pParamsBuffers[i], 0, sizeof(Params)));
+            VK_CHECK(dispatchBuffers[i]->map((void **) &pDispatchBuffers[i], 0, sizeof(Dispatch)));
+            VK_CHECK(stagingBuffers[i]->map(&pStagingBuffers[i], 0, stagingBuffers[i]->size()));
+            VK_CHECK(outputBuffers[i]->map(&pOutputBuffers[i], 0, outputBuffers[i]->size()));
+
+            outputCounts[i] = 0;
+
+            // Staging buffer to input buffer, after the history.
+            auto copier = Pipelines::Copier::create(context, groupSize, 0, 1, strides, paramsBuffers[i].get(),
+                                                    stagingBuffers[i].get(), inputBuffer.get());
+            VK_CHECK(copier != nullptr);
+            copiers[i].emplace_back(std::move(copier));
+
+            // History to the head of the input buffer.
+            copier = Pipelines::Copier::create(context, groupSize, 1, 1, strides, paramsBuffers[i].get(),
+                                               inputBuffer.get(), inputBuffer.get());
+            VK_CHECK(copier != nullptr);
+            copiers[i].emplace_back(std::move(copier));
+
+            // One invocation per branch, each work group computes all channels of an output.
+            channelizers[i] = Pipelines::Channelizer::create(context, std::min(branches, maxGroupSize), branches, decimation, tapsPerBranch, outputSize,
+                                                             paramsBuffers[i].get(), tapsBuffer.get(), inputBuffer.get(), outputBuffers[i].get());
+            VK_CHECK(channelizers[i] != nullptr);
+
+            // Created signalled, as if the slot held a completed block.
+            fences[i] = std::make_unique<VulkanFence>(context->device());
+            VK_CHECK(context->createFence(*fences[i]));
+        }
+
+        VK_CHECK(context->createCommandPool(vkCommandPool));
+
+        return true;
+    }
+
+    size_t Channelizer::prepare(Params *params, Dispatch *dispatch, size_t sampleCount) {
+        const uint32_t n = sampleCount;
+
+        // New samples are appended to the history.
+        params->copies[0] = {.srcOffset = 0, .dstOffset = history, .count = n};
+        dispatch->staging = {groupCount(n, groupSize), 1, 1};
+
+        // The newest sample of output k is at position + k * decimation, its branches are rotated by rotation + k * decimation.
+        const uint32_t outputCount = position < n ? (n - position + decimation - 1) / decimation : 0;
+
+        params->polyphase = {.outputCount = outputCount, .offset = history + position, .phase = rotation};
+        dispatch->polyphase = {std::min(outputCount, maxGroupCount), 1, 1};
+
+        // Move the last samples to the head of the input buffer.
+        params->copies[1] = {.srcOffset = n, .dstOffset = 0, .count = history};
+
+        position = position + outputCount * decimation - n;
+        rotation = (rotation + outputCount * decimation) % branches;
+
+        return outputCount;
+    }
+
+    bool Channelizer::process(const float *samples, size_t sampleCount, float *output, size_t &outputCount) {
+        VK_CHECK(sampleCount <= MAX_SAMPLE_ARRAY_SIZE);
+
+        const auto nextBufferIndex = (bufferIndex + 1) % numBuffers;
+
+        // Update parameters and dispatch sizes, the slot is free since its previous block was read back.
+        outputCounts[bufferIndex] = prepare(pParamsBuffers[bufferIndex], pDispatchBuffers[bufferIndex], sampleCount);
+
+        // Copy samples to staging buffer.
+        memcpy(pStagingBuffers[bufferIndex], samples, S2B(sampleCount));
+        stagingBuffers[bufferIndex]->flush(0, S2B(sampleCount));
+
+        if (commandBuffers[bufferIndex] == nullptr) {
+            commandBuffers[bufferIndex] = std::make_unique<VulkanCommandBuffer>(context->device(), vkCommandPool);
+            auto *commandBuffer = commandBuffers[bufferIndex].get();
+            const auto *dispatchBuffer = dispatchBuffers[bufferIndex].get();
+            // Begin command buffer.
+            VK_CHECK(context->createCommandBuffer(vkCommandPool, *commandBuffer));
+            VK_CHECK(Context::beginCommandBuffer(*commandBuffer));
+            // Wait for the previous block, it shares the input buffer.
+            Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            // Copy samples from staging buffer to input buffer.
+            copiers[bufferIndex][0]->recordComputeCommands(*commandBuffer, dispatchBuffer, Dispatch::stagingOffset());
+            // Wait for copy to complete.
+            Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            // Run filter bank and FFT.
+            channelizers[bufferIndex]->recordComputeCommands(*commandBuffer, dispatchBuffer, Dispatch::polyphaseOffset());
+            // Wait for channelizer to complete.
+            Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            // Update input buffer.
+            copiers[bufferIndex][1]->recordComputeCommands(*commandBuffer);
+            // End command buffer
+            VK_CALL(vkEndCommandBuffer, *commandBuffer);
+        }
+
+        // Submit the block, signalling the fence of the slot when it is done.
+        VK_CHECK(Submit());
+
+        // Wait for the oldest block in flight, in the next slot, if the ring is full.
+        if (blockCount + 1 >= numBuffers) {
+            VK_CALL(vkWaitForFences, context->device(), 1, *fences[nextBufferIndex], VK_TRUE, -1ull);
+        }
+
+        // Copy samples from output buffer of the oldest block, one channel after another.
+        outputCount = outputCounts[nextBufferIndex];
+        for (size_t c = 0; c < branches; c++) {
+            memcpy(output + 2 * c * outputCount, (const float *) pOutputBuffers[nextBufferIndex] + 2 * c * outputSize, S2B(outputCount));
+        }
+
+        // Advance to the next slot.
+        bufferIndex = nextBufferIndex;
+        blockCount++;
+
+        return true;
+    }
+
+    bool Channelizer::Submit() {
+        // The previous block of the slot was waited for before its output was read.
+        VK_CALL(vkResetFences, context->device(), 1, *fences[bufferIndex]);
+        VK_CHECK(context->submitCommandBuffer(*commandBuffers[bufferIndex], *fences[bufferIndex], queueIndex));
+
+        return true;
+    }
+
+    Channelizer::~Channelizer() {
+        // Wait for the blocks of this instance only, the queue may be shared with other instances.
+        for (const auto &fence: fences) {
+            if (fence != nullptr) {
+                vkWaitForFences(context->device(), 1, *fence, VK_TRUE, -1ull);
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ShiftDecimator.h"
+#include "vulkan/Context.h"
+#include "vulkan/Buffer.h"
+#include "pipelines/Channelizer.h"
+#include "pipelines/Copier.h"
+
+#define MAX_BRANCHES 4096
+#define MAX_OVERSAMPLING 4
+
+namespace Vulkan::DSP {
+    // Polyphase filter bank splitting the input into branches channels, each decimated by decimation.
+    // Channel c is centered at c / branches of the sample rate, channels past the middle are negative frequencies.
+    struct Channelizer {
+        static std::unique_ptr<Channelizer> create(Context *, std::vector<float> &&taps, size_t branches, size_t decimation, size_t depth);
+
+        Channelizer(Context *context, size_t branches, size_t decimation, size_t depth)
+            : context(context), queueIndex(context->assignQueue()), vkCommandPool(context->device()),
+              branches(branches), decimation(decimation), numBuffers(depth) {}
+        ~Channelizer();
+
+        // Outputs of all channels follow each other in output, outputCount samples each.
+        bool process(const float *samples, size_t sampleCount, float *output, size_t &outputCount);
+
+        size_t channelCount() const { return branches; }
+        size_t maxOutputCount() const { return outputSize; }
+
+    private:
+        bool initialize(std::vector<float> &);
+        size_t prepare(Params *params, Dispatch *dispatch, size_t sampleCount);
+
+        template <typename T>
+        using unique_ptrs = std::vector<std::unique_ptr<T>>;
+
+        static constexpr size_t groupSize = 64;
+        static constexpr size_t maxGroupSize = 256;
+        static constexpr uint32_t maxGroupCount = 65535;
+
+        Context * const context;
+        // Queue the instance submits to, instances are spread over the queues of the context.
+        const size_t queueIndex;
+        // Command buffers are allocated from a pool of the instance, command pools can't be shared between threads.
+        VulkanCommandPool vkCommandPool;
+
+        const size_t branches;
+        const size_t decimation;
+        size_t tapsPerBranch = 0;
+
+        // Samples kept from the previous block, the span of the prototype filter minus one.
+        uint32_t history = 0;
+        // Samples of a channel in the output buffer.
+        uint32_t outputSize = 0;
+
+        // Position of the newest sample of the next output after the history and rotation of its branches.
+        uint32_t position = 0;
+        uint32_t rotation = 0;
+
+        const size_t numBuffers;
+        size_t bufferIndex = 0;
+
+        // Number of submitted blocks, block n signals the fence of its slot.
+        uint64_t blockCount = 0;
+
+        std::unique_ptr<Buffer> tapsBuffer;
+        std::unique_ptr<Buffer> inputBuffer;
+
+        std::unique_ptr<Buffer> paramsBuffers[MAX_DEPTH];
+        std::unique_ptr<Buffer> dispatchBuffers[MAX_DEPTH];
+        std::unique_ptr<Buffer> stagingBuffers[MAX_DEPTH];
+        std::unique_ptr<Buffer> outputBuffers[MAX_DEPTH];
+
+        Params *pParamsBuffers[MAX_DEPTH];
+        Dispatch *pDispatchBuffers[MAX_DEPTH];
+        void *pStagingBuffers[MAX_DEPTH];
+        void *pOutputBuffers[MAX_DEPTH];
+
+        size_t outputCounts[MAX_DEPTH];
+
+        std::unique_ptr<Pipelines::Channelizer> channelizers[MAX_DEPTH];
+        unique_ptrs<Pipelines::Copier> copiers[MAX_DEPTH];
+
+        // Fences work on devices without timeline semaphores, blocks are only waited for from the host.
+        std::unique_ptr<VulkanFence> fences[MAX_DEPTH];
+        std::unique_ptr<VulkanCommandBuffer> commandBuffers[MAX_DEPTH];
+
+        bool Submit();
+    };
+}
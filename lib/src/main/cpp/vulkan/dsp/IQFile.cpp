@@ -0,0 +1,125 @@
+#include "IQFile.h"
+#include "vulkan/Utils.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Vulkan::DSP {
+    std::unique_ptr<IQFile> IQFile::create(Context *context, int fd, size_t headerSize, SampleFormat format) {
+        if (context == nullptr || fd < 0) {
+            return nullptr;
+        }
+        auto file = std::make_unique<IQFile>(context, format);
+        const bool success = file->initialize(fd, headerSize);
+        return success ? std::move(file) : nullptr;
+    }
+
+    bool IQFile::initialize(int fd, size_t headerSize) {
+        struct stat st = {};
+        VK_CHECK(fstat(fd, &st) == 0);
+        VK_CHECK((size_t) st.st_size >= headerSize + sampleSize(format));
+
+        void *pointer = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        VK_CHECK(pointer != MAP_FAILED);
+        madvise(pointer, st.st_size, MADV_SEQUENTIAL);
+
+        const size_t pageSize = sysconf(_SC_PAGESIZE);
+
+        mapping = (uint8_t *) pointer;
+        mappingSize = (st.st_size + pageSize - 1) / pageSize * pageSize;
+        dataOffset = headerSize;
+        dataSize = (st.st_size - headerSize) / sampleSize(format) * sampleSize(format);
+
+        importEnabled = context->supportsHostImport();
+
+        return true;
+    }
+
+    bool IQFile::importWindow(size_t slot, size_t offset, size_t size, size_t windowSize) {
+        Window &window = windows[slot];
+
+        // Consecutive blocks of the slot read the same window until one moves past its end.
+        if (window.buffer != nullptr && offset >= window.offset && offset + size <= window.offset + window.buffer->size()) {
+            return true;
+        }
+
+        const size_t alignment = context->hostImportAlignment();
+        if (!importEnabled || alignment == 0) {
+            return false;
+        }
+
+        // Windows start at aligned offsets of the page aligned mapping, a whole number of samples before the block.
+        const size_t windowOffset = offset / alignment * alignment;
+        if ((uintptr_t) mapping % alignment != 0 || (offset - windowOffset) % sampleSize(format) != 0) {
+            return false;
+        }
+
+        // The window extends past the block, but not past the mapping.
+        const size_t windowEnd = std::min((std::max(windowOffset + windowSize, offset + size) + alignment - 1) / alignment * alignment, mappingSize);
+        if (windowEnd - windowOffset > UINT32_MAX) {
+            return false;
+        }
+
+        Window next = {
+                .buffer = Buffer::import(context, mapping + windowOffset, windowEnd - windowOffset, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT),
+                .offset = windowOffset,
+        };
+        if (next.buffer == nullptr) {
+            LOGD("Failed to import IQ file window, copying blocks instead");
+            importEnabled = false;
+            return false;
+        }
+
+        // The previous window of the slot was read by a completed block.
+        window = std::move(next);
+
+        return true;
+    }
+
+    bool IQFile::decimate(ShiftDecimator &decimator, size_t sampleCount, float *output, size_t &outputCount, const float *phi, const float *omega) {
+        VK_CHECK(decimator.sampleFormat() == format);
+
+        return decimator.processChunks(sampleCount, output, outputCount, phi, omega,
+                                       [&](size_t, size_t count, const void *&, const Buffer *&staging, uint32_t &stagingOffset) {
+                                           return readBlock(decimator, count, staging, stagingOffset);
+                                       });
+    }
+
+    bool IQFile::readBlock(ShiftDecimator &decimator, size_t sampleCount, const Buffer *&staging, uint32_t &stagingOffset) {
+        const size_t size = sampleSize(format) * sampleCount;
+        VK_CHECK(size <= dataSize && size <= decimator.stagingSize());
+
+        const size_t slot = decimator.currentSlot();
+        const size_t offset = dataOffset + position;
+        position = (position + size) % dataSize;
+
+        // Blocks that don't wrap around are read in place, windows are rebound only when a block moves past the window of its slot.
+        if (offset + size <= dataOffset + dataSize && importWindow(slot, offset, size, windowBlocks * decimator.stagingSize())) {
+            staging = windows[slot].buffer.get();
+            stagingOffset = (offset - windows[slot].offset) / sampleSize(format);
+            return true;
+        }
+
+        // Copy the block straight from the mapping to the staging buffer.
+        auto *stagingBuffer = (uint8_t *) decimator.stagingBuffer(slot);
+        const size_t head = std::min(size, dataOffset + dataSize - offset);
+        memcpy(stagingBuffer, mapping + offset, head);
+        memcpy(stagingBuffer + head, mapping + dataOffset, size - head);
+
+        return true;
+    }
+
+    IQFile::~IQFile() {
+        // Blocks in flight may still read imported windows.
+        for (size_t i = 0; i < context->queueCount(); i++) {
+            context->queueWaitIdle(i);
+        }
+        for (auto &window: windows) {
+            window.buffer.reset();
+        }
+        if (mapping != nullptr) {
+            munmap(mapping, mappingSize);
+        }
+    }
+}
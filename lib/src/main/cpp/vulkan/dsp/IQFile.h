@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ShiftDecimator.h"
+#include "vulkan/Context.h"
+#include "vulkan/Buffer.h"
+
+namespace Vulkan::DSP {
+    // Recording mapped into memory and played back through a decimator, wrapping around at its end.
+    // Windows of the mapping spanning several blocks are imported into buffers read by the GPU in place, blocks outside them are copied
+    // to the staging buffer.
+    struct IQFile {
+        static std::unique_ptr<IQFile> create(Context *, int fd, size_t headerSize, SampleFormat format);
+
+        IQFile(Context *context, SampleFormat format) : context(context), format(format) {}
+        ~IQFile();
+
+        // Decimates the next sampleCount samples of the recording, see ShiftDecimator::process.
+        bool decimate(ShiftDecimator &decimator, size_t sampleCount, float *output, size_t &outputCount, const float *phi, const float *omega);
+
+    private:
+        bool initialize(int fd, size_t headerSize);
+        // Puts the next block in the staging buffer of the current slot of the decimator, or points staging at an imported window holding it.
+        bool readBlock(ShiftDecimator &decimator, size_t sampleCount, const Buffer *&staging, uint32_t &stagingOffset);
+        // Imports the window of a slot holding the block at offset, unless the current one does.
+        bool importWindow(size_t slot, size_t offset, size_t size, size_t windowSize);
+
+        Context * const context;
+        const SampleFormat format;
+
+        uint8_t *mapping = nullptr;
+        // Mapped bytes, the last page is readable past the end of the file.
+        size_t mappingSize = 0;
+        // Samples start after the header and end at the last whole sample.
+        size_t dataOffset = 0;
+        size_t dataSize = 0;
+        // Offset of the next block in the samples.
+        size_t position = 0;
+
+        // Blocks are imported until the driver refuses to.
+        bool importEnabled = false;
+        // Blocks each window of a slot spans, consecutive blocks of a slot read the same window until they move past its end.
+        static constexpr size_t windowBlocks = 16;
+        // Imported windows of the blocks in each decimator slot, a window is replaced once its slot comes around again.
+        struct Window {
+            std::unique_ptr<Buffer> buffer;
+            // Offset of the window in the mapping.
+            size_t offset = 0;
+        } windows[MAX_DEPTH];
+    };
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Vulkan::DSP {
+    // Layout of the samples uploaded to the staging buffer, must match the FORMAT constants in the shaders.
+    enum class SampleFormat : uint32_t {
+        // Interleaved floats.
+        F32 = 0,
+        // Interleaved unsigned bytes centered at 127.5, as produced by RTL-SDR.
+        U8 = 1,
+        // Interleaved signed bytes.
+        S8 = 2,
+        // Interleaved 16-bit words holding 12-bit signed values, as produced by bladeRF.
+        S12P = 3,
+        // Interleaved 16-bit signed words.
+        S16 = 4,
+    };
+
+    constexpr bool isValidSampleFormat(uint32_t format) {
+        return format <= (uint32_t) SampleFormat::S16;
+    }
+
+    // Bytes of a complex sample.
+    constexpr size_t sampleSize(SampleFormat format) {
+        switch (format) {
+            case SampleFormat::U8:
+            case SampleFormat::S8:
+                return 2 * sizeof(uint8_t);
+            case SampleFormat::S12P:
+            case SampleFormat::S16:
+                return 2 * sizeof(int16_t);
+            default:
+                return 2 * sizeof(float);
+        }
+    }
+
+    // Raw values map to (value + offset) * scale, the same as the IQ converters.
+    constexpr float sampleScale(SampleFormat format) {
+        switch (format) {
+            case SampleFormat::U8:
+            case SampleFormat::S8:
+                return 1.0f / 128.0f;
+            case SampleFormat::S12P:
+                return 1.0f / 2048.0f;
+            case SampleFormat::S16:
+                return 1.0f / 32768.0f;
+            default:
+                return 1.0f;
+        }
+    }
+
+    constexpr float sampleOffset(SampleFormat format) {
+        return format == SampleFormat::U8 ? -127.5f : 0.0f;
+    }
+
+    // Appends the FORMAT, SCALE and OFFSET specialization constants of the shaders reading the staging buffer.
+    inline void addSampleFormatConstants(std::vector<uint32_t> &constants, SampleFormat format) {
+        const float values[2] = {sampleScale(format), sampleOffset(format)};
+        uint32_t bits[2];
+        memcpy(bits, values, sizeof(bits));
+
+        constants.push_back((uint32_t) format);
+        constants.push_back(bits[0]);
+        constants.push_back(bits[1]);
+    }
+}
@@ -0,0 +1,1103 @@
+#include "ShiftDecimator.h"
+#include "vulkan/Buffer.h"
+#include "vulkan/Utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+namespace Vulkan::DSP {
+    static uint32_t groupCount(size_t count, size_t groupSize) {
+        return (count + groupSize - 1) / groupSize;
+    }
+
+    void ShiftDecimator::initializeHistory(const Taps &taps) {
+        const size_t multiple = (size_t) 1 << taps.size();
+        blockSize = (blockSize + multiple - 1) / multiple * multiple;
+
+        history.resize(taps.size());
+        carry.resize(taps.size());
+        ringOffsets.resize(taps.size());
+        ringSizes.resize(taps.size());
+
+        for (size_t i = 0; i < taps.size(); i++) {
+            history[i] = taps[i].size() - 1;
+            carry[i] = 0;
+            ringOffsets[i] = 0;
+            ringSizes[i] = inputSize(taps, i);
+        }
+    }
+
+    void ShiftDecimator::initializeCascade(const Taps &taps, size_t sharedMemorySize) {
+        const size_t numStages = taps.size();
+
+        // Input window of each stage needed for a tile of final outputs.
+        std::vector<size_t> windows(numStages + 1);
+        windows[numStages] = cascadeTileSize;
+        for (size_t i = numStages; i > 0; i--) {
+            windows[i - 1] = 2 * windows[i] - 2 + taps[i - 1].size();
+        }
+
+        cascadeStage = numStages;
+
+        // Fuse as many trailing stages as fit in shared memory, while recomputing at most as many samples as are used.
+        for (size_t i = numStages - 1; i-- > 1;) {
+            const size_t sharedSize = (windows[i] + windows[i + 1]) * 2 * sizeof(float);
+            if (sharedSize > sharedMemorySize || windows[i] > 2 * (cascadeTileSize << (numStages - i))) {
+                break;
+            }
+            cascadeStage = i;
+            cascadeWindows[0] = windows[i];
+            cascadeWindows[1] = windows[i + 1];
+        }
+    }
+
+    bool ShiftDecimator::createCascadeBuffers(const Taps &taps, std::unique_ptr<Buffer> &tapsBuffer, std::unique_ptr<Buffer> &historyBuffer) {
+        std::vector<CascadeFilter> cascadeFilters(MAX_STAGES, CascadeFilter{});
+        std::vector<float> cascadeTaps;
+        uint32_t historySize = 0;
+
+        for (size_t i = cascadeStage; i < taps.size(); i++) {
+            cascadeFilters[i].tapOffset = cascadeTaps.size();
+            cascadeFilters[i].tapCount = taps[i].size();
+            cascadeTaps.insert(cascadeTaps.end(), taps[i].begin(), taps[i].end());
+
+            // The first cascade stage keeps its history in its input buffer.
+            if (i > cascadeStage) {
+                cascadeFilters[i].historyOffset = historySize;
+                cascadeFilters[i].historySize = history[i] + 1;
+                historySize += 2 * cascadeFilters[i].historySize;
+            }
+        }
+
+        const size_t filtersSize = cascadeFilters.size() * sizeof(CascadeFilter);
+
+        tapsBuffer = Buffer::create(
+                context, filtersSize + F2B(cascadeTaps.size()),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(tapsBuffer != nullptr);
+        VK_CHECK(tapsBuffer->copyFrom(cascadeFilters.data(), 0, filtersSize));
+        VK_CHECK(tapsBuffer->copyFrom(cascadeTaps.data(), filtersSize, F2B(cascadeTaps.size())));
+
+        cascadeHistorySize = std::max(historySize, 1u);
+
+        historyBuffer = Buffer::create(
+                context, S2B(channels * cascadeHistorySize),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK(historyBuffer != nullptr);
+
+        return true;
+    }
+
+    uint32_t ShiftDecimator::inputSize(const Taps &taps, size_t stage) const {
+        // History, one carried over sample and a full block. Without barriers between the stages, stage 1 of a block writes
+        // the second ring while stage 2 of the previous block still reads it, so that ring holds two blocks.
+        const size_t blocks = stage == 1 && !stageBarriers ? 2 : 1;
+        return taps[stage].size() - 1 + 1 + blocks * (blockSize >> stage);
+    }
+
+    uint32_t ShiftDecimator::resamplerInputSize(const Taps &taps) const {
+        // History and the output of the last decimator stage.
+        return tapsPerPhase - 1 + (blockSize >> taps.size());
+    }
+
+    bool ShiftDecimator::initializeResampler(const Taps &taps, const Resampler &resampler) {
+        outputSize = blockSize >> taps.size();
+
+        if (resampler.taps.empty()) {
+            // Outputs of all channels are returned in the sample array.
+            VK_CHECK(channels * outputSize <= MAX_SAMPLE_ARRAY_SIZE);
+            return true;
+        }
+
+        // Positions in the resampler input must fit in 32 bits.
+        VK_CHECK(resampler.interpolation > 0 && resampler.interpolation <= MAX_INTERPOLATION && resampler.decimation > 0);
+
+        interpolation = resampler.interpolation;
+        decimation = resampler.decimation;
+        tapsPerPhase = (resampler.taps.size() + interpolation - 1) / interpolation;
+        polyphaseRingSize = resamplerInputSize(taps);
+
+        // Output of a full block, outputs of all channels are returned in the sample array.
+        outputSize = (outputSize * interpolation) / decimation + 1;
+        VK_CHECK(channels * outputSize <= MAX_SAMPLE_ARRAY_SIZE);
+
+        return true;
+    }
+
+    bool ShiftDecimator::createResamplerBuffers(const Taps &taps, const Resampler &resampler, std::unique_ptr<Buffer> &tapsBuffer, std::unique_ptr<Buffer> &inputBuffer) const {
+        // Same phase layout as the CPU polyphase filter, each phase is applied to consecutive input samples.
+        std::vector<float> phases(interpolation * tapsPerPhase, 0.0f);
+        for (size_t i = 0; i < resampler.taps.size(); i++) {
+            phases[((interpolation - 1) - (i % interpolation)) * tapsPerPhase + i / interpolation] = resampler.taps[i];
+        }
+
+        tapsBuffer = Buffer::create(
+                context, F2B(phases.size()),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(tapsBuffer != nullptr);
+        VK_CHECK(tapsBuffer->copyFrom(phases.data(), 0, F2B(phases.size())));
+
+        inputBuffer = Buffer::create(
+                context, S2B(channels * resamplerInputSize(taps)),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK(inputBuffer != nullptr);
+
+        return true;
+    }
+
+    bool ShiftDecimator::initializeFilter(const Taps &taps, const Filter &filter) {
+        decimatorOutputSize = outputSize;
+
+        if (filter.taps.empty()) {
+            return true;
+        }
+
+        VK_CHECK(filter.decimation > 0 && taps.size() + 1 <= MAX_STAGES);
+
+        filterStage = taps.size();
+
+        // History, samples carried over and the output of a full block of the decimators or the resampler.
+        const uint32_t filterHistory = filter.taps.size() - 1;
+        filterState = {
+                .decimation = filter.decimation,
+                .history = filterHistory,
+                .carry = 0,
+                .ringOffset = 0,
+                .ringSize = filterHistory + filter.decimation - 1 + outputSize,
+        };
+
+        outputSize = (outputSize + filter.decimation - 1) / filter.decimation;
+
+        return true;
+    }
+
+    bool ShiftDecimator::createFilterBuffers(const Filter &filter, std::unique_ptr<Buffer> &tapsBuffer, std::unique_ptr<Buffer> &inputBuffer) const {
+        tapsBuffer = Buffer::create(
+                context, F2B(filter.taps.size()),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(tapsBuffer != nullptr);
+        VK_CHECK(tapsBuffer->copyFrom(filter.taps.data(), 0, F2B(filter.taps.size())));
+
+        inputBuffer = Buffer::create(
+                context, S2B(channels * filterState.ringSize),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK(inputBuffer != nullptr);
+
+        return true;
+    }
+
+    bool ShiftDecimator::initializeDemodulator(const Taps &taps, const Demodulator &demodulator) {
+        demodulatorInputSize = outputSize;
+
+        if (demodulator.gain == 0.0f) {
+            return true;
+        }
+
+        // Quadrature demodulator, filters and de-emphasis each take a stage after the decimators and the filter.
+        demodulatorStage = taps.size() + (filterStage != 0 ? 1 : 0);
+
+        VK_CHECK(demodulator.taps.size() == demodulator.decimations.size());
+        VK_CHECK(demodulatorStage + demodulator.taps.size() + 2 <= MAX_STAGES);
+
+        for (size_t i = 0; i < demodulator.taps.size(); i++) {
+            const uint32_t decimation = demodulator.decimations[i];
+            VK_CHECK(!demodulator.taps[i].empty() && decimation > 0);
+
+            // History, samples carried over and the output of a full block of the previous stage.
+            const uint32_t filterHistory = demodulator.taps[i].size() - 1;
+            demodulatorFilters.push_back({
+                    .decimation = decimation,
+                    .history = filterHistory,
+                    .carry = 0,
+                    .ringOffset = 0,
+                    .ringSize = filterHistory + decimation - 1 + outputSize,
+            });
+
+            outputSize = (outputSize + decimation - 1) / decimation;
+        }
+
+        return true;
+    }
+
+    bool ShiftDecimator::createDemodulatorBuffers(const Demodulator &demodulator, DemodulatorBuffers &buffers) const {
+        buffers.input = Buffer::create(
+                context, S2B(channels * demodulatorInputSize),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK(buffers.input != nullptr);
+
+        // Same previous sample before the first block as the CPU demodulator.
+        std::vector<float> history(2 * 2 * channels, 0.0f);
+        for (size_t i = 0; i < 2 * channels; i++) {
+            history[2 * i] = 1.0f;
+        }
+
+        buffers.history = Buffer::create(
+                context, F2B(history.size()),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(buffers.history != nullptr);
+        VK_CHECK(buffers.history->copyFrom(history.data(), 0, F2B(history.size())));
+
+        for (size_t i = 0; i < demodulatorFilters.size(); i++) {
+            const auto &taps = demodulator.taps[i];
+
+            auto buffer = Buffer::create(
+                    context, F2B(taps.size()),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK(buffer != nullptr);
+            VK_CHECK(buffer->copyFrom(taps.data(), 0, F2B(taps.size())));
+            buffers.taps.emplace_back(std::move(buffer));
+
+            // Real samples.
+            buffer = Buffer::create(
+                    context, F2B(channels * demodulatorFilters[i].ringSize),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            VK_CHECK(buffer != nullptr);
+            buffers.rings.emplace_back(std::move(buffer));
+        }
+
+        buffers.deemphasisInput = Buffer::create(
+                context, F2B(channels * outputSize),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK(buffers.deemphasisInput != nullptr);
+
+        // Silence before the first block, as in the CPU de-emphasis.
+        const std::vector<float> state(channels, 0.0f);
+
+        buffers.deemphasisState = Buffer::create(
+                context, F2B(state.size()),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(buffers.deemphasisState != nullptr);
+        VK_CHECK(buffers.deemphasisState->copyFrom(state.data(), 0, F2B(state.size())));
+
+        return true;
+    }
+
+    bool ShiftDecimator::initialize(Taps &taps, Resampler &resampler, Filter &filter, Demodulator &demodulator, bool bakeTaps, bool halfPrecision) {
+        VK_CHECK(!taps.empty() && taps.size() <= MAX_STAGES);
+
+        initializeHistory(taps);
+        initializeCascade(taps, context->maxSharedMemorySize());
+        VK_CHECK(initializeResampler(taps, resampler));
+        VK_CHECK(initializeFilter(taps, filter));
+        VK_CHECK(initializeDemodulator(taps, demodulator));
+
+        for (size_t i = 0; i < taps.size(); i++) {
+            auto buffer = Buffer::create(
+                    context, F2B(taps[i].size()),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK(buffer != nullptr);
+            buffer->copyFrom(taps[i].data(), 0, F2B(taps[i].size()));
+            tapBuffers.emplace_back(std::move(buffer));
+
+            // Stages after the first cascade stage keep their samples in shared memory.
+            if (i > cascadeStage) {
+                continue;
+            }
+
+            buffer = Buffer::create(
+                    context, halfPrecision ? H2B(channels * inputSize(taps, i)) : S2B(channels * inputSize(taps, i)),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            VK_CHECK(buffer != nullptr);
+            inputBuffers.emplace_back(std::move(buffer));
+        }
+
+        if (cascadeStage < taps.size()) {
+            VK_CHECK(createCascadeBuffers(taps, cascadeTapsBuffer, cascadeHistoryBuffer));
+        }
+
+        if (tapsPerPhase != 0) {
+            VK_CHECK(createResamplerBuffers(taps, resampler, polyphaseTapsBuffer, polyphaseInputBuffer));
+        }
+
+        if (filterStage != 0) {
+            VK_CHECK(createFilterBuffers(filter, filterTapsBuffer, filterInputBuffer));
+        }
+
+        if (demodulatorStage != 0) {
+            VK_CHECK(createDemodulatorBuffers(demodulator, demodulatorBuffers));
+        }
+
+        // Channel strides of the buffer written by the last decimator stage or the resampler, of the buffer written by the last decimator stage
+        // and of the input buffers.
+        const uint32_t resampledStride = filterStage != 0 ? filterState.ringSize : decimatorOutputSize;
+        const uint32_t lastStride = tapsPerPhase != 0 ? resamplerInputSize(taps) : resampledStride;
+        std::vector<uint32_t> inputStrides;
+        for (size_t i = 0; i < inputBuffers.size(); i++) {
+            inputStrides.push_back(inputSize(taps, i));
+        }
+
+        for (size_t i = 0; i < numBuffers; i++) {
+            paramsBuffers[i] = Buffer::create(
+                    context, sizeof(Params),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK(paramsBuffers[i] != nullptr);
+
+            dispatchBuffers[i] = Buffer::create(
+                    context, sizeof(Dispatch),
+                    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK(dispatchBuffers[i] != nullptr);
+
+            // Samples of blocks in flight can't share the input buffer, each slot has its own staging buffer.
+            stagingBuffers[i] = Buffer::create(
+                    context, sampleSize(format) * blockSize,
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            VK_CHECK(stagingBuffers[i] != nullptr);
+
+            outputBuffers[i] = Buffer::create(
+                    context, S2B(channels * outputSize),
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK(outputBuffers[i] != nullptr);
+
+            VK_CHECK(paramsBuffers[i]->map((void **) &pParamsBuffers[i], 0, sizeof(Params)));
+            VK_CHECK(dispatchBuffers[i]->map((void **) &pDispatchBuffers[i], 0, sizeof(Dispatch)));
+            VK_CHECK(stagingBuffers[i]->map(&pStagingBuffers[i], 0, stagingBuffers[i]->size()));
+            VK_CHECK(outputBuffers[i]->map(&pOutputBuffers[i], 0, outputBuffers[i]->size()));
+
+            boundStagingGenerations[i] = stagingBuffers[i]->generation();
+
+            // Last decimator stage feeds the resampler, the filter and the demodulator, whichever of them come next.
+            const Buffer *filteredBuffer = demodulatorStage != 0 ? demodulatorBuffers.input.get() : outputBuffers[i].get();
+            const Buffer *resampledBuffer = filterStage != 0 ? filterInputBuffer.get() : filteredBuffer;
+            const Buffer *lastBuffer = tapsPerPhase != 0 ? polyphaseInputBuffer.get() : resampledBuffer;
+
+            // Staging buffer to first input ring, converting and shifting samples on the way.
+            // All channels read the same staging buffer.
+            const uint32_t stagingStrides[2] = {0, inputStrides[0]};
+            stagingCopiers[i] = Pipelines::Copier::create(context, groupSize, 0, channels, stagingStrides, paramsBuffers[i].get(),
+                                                          stagingBuffers[i].get(), inputBuffers[0].get(), true, false, halfPrecision, format);
+            VK_CHECK(stagingCopiers[i] != nullptr);
+
+            for (size_t j = 0; j < taps.size() && j <= cascadeStage; j++) {
+                if (j == cascadeStage) {
+                    const uint32_t cascadeStrides[3] = {inputStrides[j], cascadeHistorySize, lastStride};
+                    cascades[i] = Pipelines::Cascade::create(context, groupSize, cascadeTileSize, cascadeWindows, cascadeStrides, halfPrecision,
+                                                             j, taps.size() - 1, paramsBuffers[i].get(), cascadeTapsBuffer.get(), inputBuffers[j].get(),
+                                                             cascadeHistoryBuffer.get(), lastBuffer);
+                    VK_CHECK(cascades[i] != nullptr);
+                    break;
+                }
+
+                const Buffer *outBuffer = j < taps.size() - 1 ? inputBuffers[j + 1].get() : lastBuffer;
+                const uint32_t strides[2] = {inputStrides[j], j < taps.size() - 1 ? inputStrides[j + 1] : lastStride};
+                // Only the input buffers hold half precision samples.
+                const bool halfBuffers[2] = {halfPrecision, halfPrecision && j < taps.size() - 1};
+
+                // First stage shifts new samples as it reads them from the staging buffer.
+                if (j == 0) {
+                    shiftDecimators[i] = Pipelines::ShiftDecimator::create(context, groupSize, strides, halfBuffers, taps[j], bakeTaps, format,
+                                                                           paramsBuffers[i].get(), tapBuffers[j].get(), inputBuffers[j].get(),
+                                                                           stagingBuffers[i].get(), outBuffer);
+                    VK_CHECK(shiftDecimators[i] != nullptr);
+                    continue;
+                }
+
+                auto decimator = Pipelines::Decimator::create(context, groupSize, j, strides, halfBuffers, taps[j], bakeTaps,
+                                                              paramsBuffers[i].get(), tapBuffers[j].get(), inputBuffers[j].get(), outBuffer);
+                VK_CHECK(decimator != nullptr);
+                decimators[i].emplace_back(std::move(decimator));
+            }
+
+            if (tapsPerPhase != 0) {
+                const uint32_t polyphaseStrides[2] = {lastStride, resampledStride};
+                polyphases[i] = Pipelines::Polyphase::create(context, groupSize, interpolation, decimation, tapsPerPhase, polyphaseStrides,
+                                                             paramsBuffers[i].get(), polyphaseTapsBuffer.get(),
+                                                             polyphaseInputBuffer.get(), resampledBuffer);
+                VK_CHECK(polyphases[i] != nullptr);
+            }
+
+            if (filterStage != 0) {
+                const uint32_t filterStrides[2] = {filterState.ringSize, demodulatorStage != 0 ? demodulatorInputSize : outputSize};
+                firs[i] = Pipelines::FIR::create(context, groupSize, filterStage, filterStrides, filterState.decimation, filter.taps, true,
+                                                 paramsBuffers[i].get(), filterTapsBuffer.get(), filterInputBuffer.get(), filteredBuffer);
+                VK_CHECK(firs[i] != nullptr);
+            }
+
+            if (demodulatorStage != 0) {
+                const size_t filterCount = demodulatorFilters.size();
+
+                // Demodulated samples go to the first filter ring, or to the de-emphasis input without filters.
+                const uint32_t quadratureStrides[2] = {demodulatorInputSize, filterCount != 0 ? demodulatorFilters[0].ringSize : outputSize};
+                const Buffer *quadratureBuffer = filterCount != 0 ? demodulatorBuffers.rings[0].get() : demodulatorBuffers.deemphasisInput.get();
+                quadratures[i] = Pipelines::Quadrature::create(context, groupSize, demodulatorStage, quadratureStrides, demodulator.gain,
+                                                               paramsBuffers[i].get(), demodulatorBuffers.input.get(),
+                                                               demodulatorBuffers.history.get(), quadratureBuffer);
+                VK_CHECK(quadratures[i] != nullptr);
+
+                for (size_t j = 0; j < filterCount; j++) {
+                    const bool lastFilter = j + 1 == filterCount;
+                    const uint32_t strides[2] = {demodulatorFilters[j].ringSize, lastFilter ? outputSize : demodulatorFilters[j + 1].ringSize};
+                    const Buffer *outBuffer = lastFilter ? demodulatorBuffers.deemphasisInput.get() : demodulatorBuffers.rings[j + 1].get();
+
+                    auto fir = Pipelines::FIR::create(context, groupSize, demodulatorStage + 1 + j, strides, demodulatorFilters[j].decimation,
+                                                      demodulator.taps[j], false, paramsBuffers[i].get(), demodulatorBuffers.taps[j].get(),
+                                                      demodulatorBuffers.rings[j].get(), outBuffer);
+                    VK_CHECK(fir != nullptr);
+                    filters[i].emplace_back(std::move(fir));
+                }
+
+                const uint32_t deemphasisStrides[2] = {outputSize, outputSize};
+                deemphases[i] = Pipelines::Deemphasis::create(context, groupSize, demodulatorStage + 1 + filterCount, deemphasisStrides,
+                                                              demodulator.deemphasis, paramsBuffers[i].get(), demodulatorBuffers.deemphasisInput.get(),
+                                                              demodulatorBuffers.deemphasisState.get(), outputBuffers[i].get());
+                VK_CHECK(deemphases[i] != nullptr);
+            }
+        }
+
+        VK_CHECK(context->createCommandPool(vkCommandPool));
+        VK_CHECK(context->createQueryPool(4 * numBuffers, vkQueryPool));
+
+        return true;
+    }
+
+    size_t ShiftDecimator::prepare(Params *params, Dispatch *dispatch, size_t sampleCount, const float *phi, const float *omega) {
+        for (size_t c = 0; c < channels; c++) {
+            params->shifts[c] = {.phi = phi[c], .omega = omega[c]};
+        }
+
+        // Sample counts are the same for all channels, each runs in its own row of work groups.
+        const uint32_t rows = channels;
+
+        // New samples are appended to the history of the first stage, which is shifted already.
+        const uint32_t inputOffset = history[0] + carry[0];
+
+        params->shifterOffset = inputOffset;
+        params->shifterCount = sampleCount;
+
+        params->historyIndex = historyIndex;
+        historyIndex ^= 1;
+
+        size_t inputCount = sampleCount;
+
+        for (size_t i = 0; i < history.size(); i++) {
+            // Each stage consumes samples in pairs, an odd sample is carried over to the next block.
+            const size_t available = carry[i] + inputCount;
+            const size_t outputCount = available / 2;
+
+            carry[i] = available - 2 * outputCount;
+
+            // Outputs follow the samples the next stage kept from the previous block.
+            params->stages[i] = {
+                    .outputCount = (uint32_t) outputCount,
+                    .outputOffset = i + 1 < history.size() ? (ringOffsets[i + 1] + history[i + 1] + carry[i + 1]) % ringSizes[i + 1] : 0,
+                    .inputOffset = ringOffsets[i],
+            };
+            dispatch->stages[i] = {groupCount(outputCount, groupSize), rows, 1};
+
+            // Consumed samples leave the ring, the unconsumed ones stay where they are.
+            if (i <= cascadeStage) {
+                ringOffsets[i] = (ringOffsets[i] + 2 * outputCount) % ringSizes[i];
+            }
+
+            inputCount = outputCount;
+        }
+
+        // The first stage reads new samples from the staging buffer, those still needed are copied shifted after its history.
+        const uint32_t consumed = 2 * params->stages[0].outputCount;
+        const uint32_t first = std::max(consumed, inputOffset);
+
+        params->copies[0] = {
+                .srcOffset = first - inputOffset,
+                .dstOffset = (params->stages[0].inputOffset + first) % ringSizes[0],
+                .count = (uint32_t) (inputOffset + sampleCount - first),
+        };
+        dispatch->staging = {groupCount(params->copies[0].count, groupSize), rows, 1};
+
+        // The first cascade work group also updates the history, so at least one always runs.
+        dispatch->cascade = {std::max(groupCount(inputCount, cascadeTileSize), 1u), rows, 1};
+
+        if (tapsPerPhase != 0) {
+            // Last decimator stage appends to the resampler history.
+            params->stages[history.size() - 1].outputOffset = (polyphaseRingOffset + tapsPerPhase - 1) % polyphaseRingSize;
+
+            // Output k uses phase (phase + k * decimation) % interpolation at offset + (phase + k * decimation) / interpolation.
+            const uint64_t outputCount = polyphaseOffset < inputCount
+                                         ? ((uint64_t) interpolation * (inputCount - polyphaseOffset) - polyphasePhase + decimation - 1) / decimation
+                                         : 0;
+
+            params->polyphase = {
+                    .outputCount = (uint32_t) outputCount,
+                    .offset = (polyphaseRingOffset + polyphaseOffset) % polyphaseRingSize,
+                    .phase = polyphasePhase,
+                    .outputOffset = 0,
+            };
+            dispatch->polyphase = {groupCount(outputCount, groupSize), rows, 1};
+
+            const uint64_t position = polyphasePhase + outputCount * decimation;
+            polyphaseOffset = polyphaseOffset + position / interpolation - inputCount;
+            polyphasePhase = position % interpolation;
+            polyphaseRingOffset = (polyphaseRingOffset + inputCount) % polyphaseRingSize;
+
+            inputCount = outputCount;
+        }
+
+        if (filterStage != 0) {
+            // Last decimator stage or the resampler appends to the filter history.
+            if (tapsPerPhase != 0) {
+                params->polyphase.outputOffset = filterState.writeOffset();
+            } else {
+                params->stages[history.size() - 1].outputOffset = filterState.writeOffset();
+            }
+
+            inputCount = prepareRingFilter(filterState, filterStage, inputCount, 0, params, dispatch);
+        }
+
+        if (demodulatorStage != 0) {
+            inputCount = prepareDemodulator(params, dispatch, inputCount);
+        }
+
+        return inputCount;
+    }
+
+    size_t ShiftDecimator::prepareRingFilter(RingFilter &ringFilter, size_t stage, size_t inputCount, uint32_t outputOffset, Params *params, Dispatch *dispatch) {
+        // Consumes samples in groups of the decimation, the rest is carried over to the next block.
+        const size_t available = ringFilter.carry + inputCount;
+        const size_t outputCount = available / ringFilter.decimation;
+
+        ringFilter.carry = available - ringFilter.decimation * outputCount;
+
+        params->stages[stage] = {
+                .outputCount = (uint32_t) outputCount,
+                .outputOffset = outputOffset,
+                .inputOffset = ringFilter.ringOffset,
+        };
+        dispatch->stages[stage] = {groupCount(outputCount, groupSize), (uint32_t) channels, 1};
+
+        ringFilter.ringOffset = (ringFilter.ringOffset + ringFilter.decimation * outputCount) % ringFilter.ringSize;
+
+        return outputCount;
+    }
+
+    size_t ShiftDecimator::prepareDemodulator(Params *params, Dispatch *dispatch, size_t inputCount) {
+        const uint32_t rows = channels;
+        const size_t filterCount = demodulatorFilters.size();
+
+        // Outputs of a stage follow the samples the next filter kept from the previous block, the de-emphasis input is not a ring.
+        const auto nextOffset = [&](size_t i) {
+            return i < filterCount ? demodulatorFilters[i].writeOffset() : 0u;
+        };
+
+        params->stages[demodulatorStage] = {
+                .outputCount = (uint32_t) inputCount,
+                .outputOffset = nextOffset(0),
+                .inputOffset = 0,
+        };
+        // The first work group also keeps the previous sample when there are no samples, so at least one always runs.
+        dispatch->stages[demodulatorStage] = {std::max(groupCount(inputCount, groupSize), 1u), rows, 1};
+
+        for (size_t i = 0; i < filterCount; i++) {
+            inputCount = prepareRingFilter(demodulatorFilters[i], demodulatorStage + 1 + i, inputCount, nextOffset(i + 1), params, dispatch);
+        }
+
+        // De-emphasis runs each channel in a single work group.
+        params->stages[demodulatorStage + 1 + filterCount] = {
+                .outputCount = (uint32_t) inputCount,
+                .outputOffset = 0,
+                .inputOffset = 0,
+        };
+        dispatch->stages[demodulatorStage + 1 + filterCount] = {1, rows, 1};
+
+        return inputCount;
+    }
+
+    bool ShiftDecimator::process(const void *samples, size_t sampleCount, float *output, size_t &outputCount, const float *phi, const float *omega) {
+        // Chunks are taken from the samples, a block in the staging buffer can't be larger than it.
+        VK_CHECK(samples != nullptr || sampleCount <= blockSize);
+
+        return processChunks(sampleCount, output, outputCount, phi, omega, [&](size_t offset, size_t, const void *&chunk, const Buffer *&, uint32_t &) {
+            chunk = samples != nullptr ? (const uint8_t *) samples + sampleSize(format) * offset : nullptr;
+            return true;
+        });
+    }
+
+    bool ShiftDecimator::processChunks(size_t sampleCount, float *output, size_t &outputCount, const float *phi, const float *omega,
+                                       const ChunkFunction &getChunk) {
+        const size_t chunkCount = std::max<size_t>((sampleCount + blockSize - 1) / blockSize, 1);
+
+        // Outputs of earlier chunks would be overwritten in the output buffers.
+        VK_CHECK(output != nullptr || chunkCount == 1);
+        // The outputs of a full ring would not fit in the output.
+        VK_CHECK(pending.size() < slotCount());
+
+        // Nothing comes out until the ring is full, then slotCount() - 1 blocks stay in flight as with one block per call.
+        const size_t blocks = pending.size() + chunkCount;
+        const size_t returnCount = blocks >= slotCount() ? blocks - (slotCount() - 1) : 0;
+
+        size_t next = 0;
+        size_t batchEnd = 0;
+        float chunkPhi[MAX_CHANNELS];
+
+        // Stages chunks into the free slots and submits them once the whole batch is staged, batches are as large as the ring.
+        // Chunks are staged before the outputs of older blocks are written, which may overwrite the samples.
+        const auto stageChunks = [&]() {
+            if (staged == 0) {
+                batchEnd = next + std::min(chunkCount - next, slotCount());
+            }
+            for (; next < batchEnd && pending.size() < slotCount(); next++) {
+                const size_t offset = next * blockSize;
+                const size_t count = std::min(blockSize, sampleCount - offset);
+                const void *samples = nullptr;
+                const Buffer *staging = nullptr;
+                uint32_t stagingOffset = 0;
+                VK_CHECK(getChunk(offset, count, samples, staging, stagingOffset));
+                chunkPhase(phi, omega, offset, chunkPhi);
+                VK_CHECK(stageBlock(staging, stagingOffset, samples, count, blockCount + staged, chunkPhi, omega));
+            }
+            // The oldest block has to be submitted to complete.
+            if (next == batchEnd || pending.size() == staged) {
+                VK_CHECK(submitStaged());
+            }
+            return true;
+        };
+
+        outputCount = 0;
+
+        if (returnCount > 0) {
+            VK_CHECK(gatherBlocks(returnCount, output, outputCount, [&](size_t index, float *blockOutput, size_t &count) {
+                VK_CHECK(stageChunks());
+                VK_CHECK(completeOldest(blockOutput, count));
+                // The ring has room for the chunks left, they are staged before the outputs are gathered over the samples.
+                if (index + 1 == returnCount) {
+                    VK_CHECK(stageChunks());
+                }
+                return true;
+            }));
+        } else {
+            VK_CHECK(stageChunks());
+        }
+
+        VK_CHECK(next == chunkCount && staged == 0);
+
+        return true;
+    }
+
+    bool ShiftDecimator::flush(float *output, size_t &outputCount) {
+        outputCount = 0;
+        if (pending.empty()) {
+            return true;
+        }
+
+        // Outputs of earlier blocks would be left in the output buffers of their slots.
+        VK_CHECK(output != nullptr || pending.size() == 1);
+
+        return gatherBlocks(pending.size(), output, outputCount, [&](size_t, float *blockOutput, size_t &count) {
+            return completeOldest(blockOutput, count);
+        });
+    }
+
+    bool ShiftDecimator::submit(const void *samples, size_t sampleCount, uint64_t sequence, const float *phi, const float *omega) {
+        const size_t chunkCount = std::max<size_t>((sampleCount + blockSize - 1) / blockSize, 1);
+
+        // Chunks are taken from the samples, each needs a free slot.
+        VK_CHECK(samples != nullptr || chunkCount == 1);
+        VK_CHECK(pending.size() + chunkCount <= slotCount());
+
+        float chunkPhi[MAX_CHANNELS];
+
+        for (size_t i = 0; i < chunkCount; i++) {
+            const size_t offset = i * blockSize;
+            chunkPhase(phi, omega, offset, chunkPhi);
+            const void *chunk = samples != nullptr ? (const uint8_t *) samples + sampleSize(format) * offset : nullptr;
+            VK_CHECK(stageBlock(nullptr, 0, chunk, std::min(blockSize, sampleCount - offset), sequence + i, chunkPhi, omega));
+        }
+
+        return submitStaged();
+    }
+
+    bool ShiftDecimator::poll(float *output, Completion &completion, bool &completed) {
+        completed = false;
+        if (pending.empty()) {
+            return true;
+        }
+        return completePending(false, output, completion, completed);
+    }
+
+    bool ShiftDecimator::wait(uint64_t sequence, float *output, Completion &completion) {
+        // Blocks complete in order, an earlier block still in flight would hold up the wait.
+        VK_CHECK(!pending.empty() && pending.front().sequence == sequence);
+
+        bool completed = false;
+        return completePending(true, output, completion, completed);
+    }
+
+    static uint64_t monotonicTime() {
+        timespec ts = {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+
+    bool ShiftDecimator::stageBlock(const Buffer *staging, uint32_t stagingOffset, const void *samples, size_t sampleCount, uint64_t sequence,
+                                    const float *phi, const float *omega) {
+        VK_CHECK(sampleCount <= blockSize);
+        // The slot of the oldest block is only free once it was returned, its outputs are still in its output buffer.
+        VK_CHECK(pending.size() < slotCount());
+
+        Completion block;
+        block.sequence = sequence;
+        block.slot = currentSlot();
+
+        VK_CHECK(prepareBlock(staging, stagingOffset, samples, sampleCount, block.outputCount, phi, omega));
+
+        pending.push_back(block);
+        staged++;
+
+        return true;
+    }
+
+    bool ShiftDecimator::submitStaged() {
+        if (staged == 0) {
+            return true;
+        }
+
+        VK_CHECK(submitBlocks(staged));
+
+        const uint64_t submitTime = monotonicTime();
+        for (size_t i = pending.size() - staged; i < pending.size(); i++) {
+            pending[i].submitTime = submitTime;
+        }
+
+        blockCount += staged;
+        staged = 0;
+
+        return true;
+    }
+
+    bool ShiftDecimator::completePending(bool wait, float *output, Completion &completion, bool &completed) {
+        // Staged blocks would never complete.
+        VK_CHECK(pending.size() > staged);
+
+        const Completion &block = pending.front();
+        const uint64_t blockNumber = blockCount - (pending.size() - staged);
+
+        // Wait for the block, or only check whether it is done.
+        counters.getTime(counters.waitTimestamp[0]);
+        VK_CHECK(completeBlock(blockNumber, wait, completed));
+        counters.getTime(counters.waitTimestamp[1]);
+        if (!completed) {
+            return true;
+        }
+
+        completion = block;
+        completion.completionTime = monotonicTime();
+        completion.gpuTime = readGpuTime(block.slot);
+        pending.pop_front();
+
+        // Copy samples from the output buffer of the block, one channel after another, unless they are read in place.
+        const float *outputBuffer = this->outputBuffer(completion.slot);
+        for (size_t c = 0; c < channels && output != nullptr; c++) {
+            memcpy(output + 2 * c * completion.outputCount, outputBuffer + 2 * c * outputSize, S2B(completion.outputCount));
+        }
+
+        return true;
+    }
+
+    bool ShiftDecimator::completeOldest(float *output, size_t &outputCount) {
+        Completion completion;
+        bool completed = false;
+        VK_CHECK(completePending(true, output, completion, completed));
+        outputCount = completion.outputCount;
+        return true;
+    }
+
+    bool ShiftDecimator::prepareBlock(const Buffer *staging, uint32_t stagingOffset, const void *samples, size_t sampleCount, size_t &outputCount,
+                                      const float *phi, const float *omega) {
+        VK_CHECK(sampleCount <= blockSize);
+
+        if (staging == nullptr) {
+            staging = stagingBuffers[bufferIndex].get();
+            stagingOffset = 0;
+        }
+
+        // Point the first stage at the buffer holding the samples, its commands are recorded again.
+        // Blocks at other offsets of the same buffer only change the parameters.
+        if (boundStagingGenerations[bufferIndex] != staging->generation()) {
+            VK_CHECK(shiftDecimators[bufferIndex]->setStagingBuffer(staging));
+            VK_CHECK(stagingCopiers[bufferIndex]->setInputBuffer(staging));
+            boundStagingGenerations[bufferIndex] = staging->generation();
+            commandBuffers[bufferIndex][0].reset();
+        }
+
+        counters.getTime(counters.submitTimestamps[bufferIndex]);
+
+        // Update parameters and dispatch sizes, the slot is free since its previous block was returned.
+        outputCount = prepare(pParamsBuffers[bufferIndex], pDispatchBuffers[bufferIndex], sampleCount, phi, omega);
+        pParamsBuffers[bufferIndex]->stagingOffset = stagingOffset;
+
+        // Copy samples to staging buffer, unless they were written there or are in a buffer of the caller.
+        if (staging == stagingBuffers[bufferIndex].get()) {
+            if (samples != nullptr) {
+                memcpy(pStagingBuffers[bufferIndex], samples, sampleSize(format) * sampleCount);
+            }
+            stagingBuffers[bufferIndex]->flush(0, sampleSize(format) * sampleCount);
+        }
+
+        // Record the command buffers of the slot, unless they are recorded already.
+        VK_CHECK(recordCommandBuffers());
+
+        // Advance to the next slot.
+        bufferIndex = (bufferIndex + 1) % numBuffers;
+
+        return true;
+    }
+
+    bool ShiftDecimator::recordCommandBuffers() {
+        // Stage 1 - shifter and first decimator.
+        if (commandBuffers[bufferIndex][0] == nullptr) {
+            commandBuffers[bufferIndex][0] = std::make_unique<VulkanCommandBuffer>(context->device(), vkCommandPool);
+            auto *commandBuffer = commandBuffers[bufferIndex][0].get();
+            // Begin command buffer.
+            VK_CHECK(context->createCommandBuffer(vkCommandPool, *commandBuffer));
+            VK_CHECK(Context::beginCommandBuffer(*commandBuffer));
+            // Reset timestamps.
+            vkCmdResetQueryPool(*commandBuffer, vkQueryPool, 4 * bufferIndex, 4);
+            // Get start timestamp.
+            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vkQueryPool, 4 * bufferIndex + 0);
+            // Wait for the previous block, it shares the input buffers.
+            if (stageBarriers) {
+                Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            }
+            // Run shifter and first decimator.
+            recordStages(*commandBuffer, 0, 1);
+            // Get end timestamp.
+            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkQueryPool, 4 * bufferIndex + 1);
+            // End command buffer
+            VK_CALL(vkEndCommandBuffer, *commandBuffer);
+        }
+
+        // Stage 2 - remaining decimators, resampler, filter and demodulator.
+        if (commandBuffers[bufferIndex][1] == nullptr) {
+            commandBuffers[bufferIndex][1] = std::make_unique<VulkanCommandBuffer>(context->device(), vkCommandPool);
+            auto *commandBuffer = commandBuffers[bufferIndex][1].get();
+            // Begin command buffer.
+            VK_CHECK(context->createCommandBuffer(vkCommandPool, *commandBuffer));
+            VK_CHECK(Context::beginCommandBuffer(*commandBuffer));
+            // Get start timestamp.
+            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkQueryPool, 4 * bufferIndex + 2);
+            // Wait for stage 1 to complete.
+            if (stageBarriers) {
+                Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            }
+            // Run remaining decimators.
+            recordStages(*commandBuffer, 1, tapBuffers.size());
+            // Run resampler.
+            recordResampler(*commandBuffer);
+            // Run filter.
+            recordFilter(*commandBuffer);
+            // Run demodulator.
+            recordDemodulator(*commandBuffer);
+            // Get end timestamp.
+            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkQueryPool, 4 * bufferIndex + 3);
+            // End command buffer
+            VK_CALL(vkEndCommandBuffer, *commandBuffer);
+        }
+
+        return true;
+    }
+
+    void ShiftDecimator::recordStages(VkCommandBuffer commandBuffer, size_t first, size_t last) {
+        const auto *dispatchBuffer = dispatchBuffers[bufferIndex].get();
+
+        for (size_t i = first; i < last && i <= cascadeStage; i++) {
+            if (i == cascadeStage) {
+                // Run all remaining stages.
+                cascades[bufferIndex]->recordComputeCommands(commandBuffer, dispatchBuffer, Dispatch::cascadeOffset());
+            } else if (i == 0) {
+                // Run shifter and first decimator.
+                shiftDecimators[bufferIndex]->recordComputeCommands(commandBuffer, dispatchBuffer, Dispatch::stageOffset(i));
+            } else {
+                // Run decimator.
+                decimators[bufferIndex][i - 1]->recordComputeCommands(commandBuffer, dispatchBuffer, Dispatch::stageOffset(i));
+            }
+            if (i == 0) {
+                // Copy the unconsumed new samples, shifted, from staging buffer to input ring.
+                // They land after the history the first stage reads, so both run at once.
+                stagingCopiers[bufferIndex]->recordComputeCommands(commandBuffer, dispatchBuffer, Dispatch::stagingOffset());
+            }
+            // Wait for decimator to complete. Its history stays in the input ring, nothing is moved.
+            Context::addStageBarrier(&commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+    }
+
+    void ShiftDecimator::recordResampler(VkCommandBuffer commandBuffer) {
+        if (polyphases[bufferIndex] == nullptr) {
+            return;
+        }
+
+        // Run resampler, the last decimator was waited for after it ran. Its history stays in the input ring.
+        polyphases[bufferIndex]->recordComputeCommands(commandBuffer, dispatchBuffers[bufferIndex].get(), Dispatch::polyphaseOffset());
+    }
+
+    void ShiftDecimator::recordFilter(VkCommandBuffer commandBuffer) {
+        if (firs[bufferIndex] == nullptr) {
+            return;
+        }
+
+        // Wait for resampler to complete, the last decimator was waited for after it ran.
+        if (polyphases[bufferIndex] != nullptr) {
+            Context::addStageBarrier(&commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+        // Run filter, its history stays in its input ring.
+        firs[bufferIndex]->recordComputeCommands(commandBuffer, dispatchBuffers[bufferIndex].get(), Dispatch::stageOffset(filterStage));
+    }
+
+    void ShiftDecimator::recordDemodulator(VkCommandBuffer commandBuffer) {
+        if (quadratures[bufferIndex] == nullptr) {
+            return;
+        }
+
+        const auto *dispatchBuffer = dispatchBuffers[bufferIndex].get();
+
+        // Wait for resampler or filter to complete, the last decimator was waited for after it ran.
+        if (polyphases[bufferIndex] != nullptr || firs[bufferIndex] != nullptr) {
+            Context::addStageBarrier(&commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+        // Run quadrature demodulator.
+        quadratures[bufferIndex]->recordComputeCommands(commandBuffer, dispatchBuffer, Dispatch::stageOffset(demodulatorStage));
+
+        size_t stage = demodulatorStage + 1;
+        for (const auto &filter: filters[bufferIndex]) {
+            // Wait for the previous stage to complete, then run filter.
+            Context::addStageBarrier(&commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            filter->recordComputeCommands(commandBuffer, dispatchBuffer, Dispatch::stageOffset(stage++));
+        }
+
+        // Wait for the last filter to complete, then run de-emphasis.
+        Context::addStageBarrier(&commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        deemphases[bufferIndex]->recordComputeCommands(commandBuffer, dispatchBuffer, Dispatch::stageOffset(stage));
+    }
+
+    uint64_t ShiftDecimator::readGpuTime(size_t slot) {
+        // Read timestamps of both stages, from the start of stage 1 to the end of stage 2.
+        uint64_t values[8];
+        vkGetQueryPoolResults(context->device(), vkQueryPool,
+                              4 * slot, 4, sizeof(values), values, 2 * sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        uint64_t gpuTime = 0;
+        if (values[1] != 0 && values[7] != 0) {
+            gpuTime = (uint64_t) (double(values[6] - values[0]) * context->timestampPeriod());
+        }
+
+        // Update timestamp stats.
+        if (counters.enable) {
+            updateCounters(slot, values);
+        }
+
+        return gpuTime;
+    }
+
+    void ShiftDecimator::updateCounters(size_t slot, const uint64_t *values) {
+        auto delta = (counters.waitTimestamp[1].tv_sec - counters.waitTimestamp[0].tv_sec) * 1000000L +
+                     (counters.waitTimestamp[1].tv_nsec - counters.waitTimestamp[0].tv_nsec) / 1000L;
+        counters.waitTimeMin = std::min(counters.waitTimeMin, (unsigned long) delta);
+        counters.waitTimeMax = std::max(counters.waitTimeMax, (unsigned long) delta);
+        counters.waitTimeSum = counters.waitTimeSum + delta;
+
+        delta = (counters.waitTimestamp[1].tv_sec - counters.submitTimestamps[slot].tv_sec) * 1000000L +
+                (counters.waitTimestamp[1].tv_nsec - counters.submitTimestamps[slot].tv_nsec) / 1000L;
+        counters.totalTimeMin = std::min(counters.totalTimeMin, (unsigned long) delta);
+        counters.totalTimeMax = std::max(counters.totalTimeMax, (unsigned long) delta);
+        counters.totalTimeSum = counters.totalTimeSum + delta;
+
+        for (size_t j = 0; j < numStages; j++) {
+            if (values[4 * j + 1] != 0 && values[4 * j + 3] != 0) {
+                const auto t0 = values[4 * j + 0];
+                const auto t1 = values[4 * j + 2];
+                const auto commandTime = float(t1 - t0) * context->timestampPeriod() / 1000.0f;
+                counters.stages[j].timeMin = std::min(counters.stages[j].timeMin, commandTime);
+                counters.stages[j].timeMax = std::max(counters.stages[j].timeMax, commandTime);
+                counters.stages[j].timeSum = counters.stages[j].timeSum + commandTime;
+            }
+        }
+
+        if (++counters.counter == 120) {
+            LOGD("DSP "
+                 "stage 1: %4.0fus / %4.0fus / %4.0fus, "
+                 "stage 2: %4.0fus / %4.0fus / %4.0fus, "
+                 "wait: %4luus / %4luus / %4luus, "
+                 "total: %4luus / %4luus / %4luus",
+                 counters.stages[0].timeMin, counters.stages[0].timeSum / counters.counter, counters.stages[0].timeMax,
+                 counters.stages[1].timeMin, counters.stages[1].timeSum / counters.counter, counters.stages[1].timeMax,
+                 counters.waitTimeMin, counters.waitTimeSum / counters.counter, counters.waitTimeMax,
+                 counters.totalTimeMin, counters.totalTimeSum / counters.counter, counters.totalTimeMax);
+
+            for (auto &stage: counters.stages) {
+                stage.timeMin = MAXFLOAT;
+                stage.timeMax = 0.0f;
+                stage.timeSum = 0.0f;
+            }
+
+            counters.totalTimeMin = counters.waitTimeMin = LONG_MAX;
+            counters.totalTimeMax = counters.waitTimeMax = 0;
+            counters.totalTimeSum = counters.waitTimeSum = 0;
+
+            counters.counter = 0;
+        }
+    }
+
+    void ShiftDecimator::chunkPhase(const float *phi, const float *omega, size_t offset, float *chunkPhi) const {
+        for (size_t c = 0; c < channels; c++) {
+            chunkPhi[c] = (float) std::fmod((double) phi[c] + (double) omega[c] * (double) offset, 2.0 * M_PI);
+        }
+    }
+
+    bool ShiftDecimator::gatherBlocks(size_t blocks, float *output, size_t &outputCount, const BlockFunction &outputBlock) {
+        // A single block is laid out as the output already, and may be read in place.
+        if (blocks == 1) {
+            return outputBlock(0, output, outputCount);
+        }
+
+        // A single channel is written straight to the output, block outputs follow each other there already.
+        if (channels > 1) {
+            chunkOutputs.resize(2 * channels * blocks * outputSize);
+        }
+        chunkCounts.clear();
+
+        size_t totalCount = 0;
+
+        for (size_t i = 0; i < blocks; i++) {
+            float *blockOutput = channels > 1 ? chunkOutputs.data() + 2 * channels * totalCount : output + 2 * totalCount;
+            size_t blockOutputCount = 0;
+            VK_CHECK(outputBlock(i, blockOutput, blockOutputCount));
+
+            chunkCounts.push_back(blockOutputCount);
+            totalCount += blockOutputCount;
+        }
+
+        // Put the outputs of each channel one after another, as for a single block.
+        if (channels > 1) {
+            float *channelOutput = output;
+            for (size_t c = 0; c < channels; c++) {
+                size_t position = 0;
+                for (const size_t count: chunkCounts) {
+                    memcpy(channelOutput, chunkOutputs.data() + 2 * (channels * position + c * count), S2B(count));
+                    channelOutput += 2 * count;
+                    position += count;
+                }
+            }
+        }
+
+        outputCount = totalCount;
+
+        return true;
+    }
+}
@@ -1,19 +1,431 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <cmath>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <algorithm>
 #include <vector>
+#include <memory>
+#include <vulkan/vulkan_core.h>
 
+#include "SampleFormat.h"
+#include "vulkan/Buffer.h"
+#include "vulkan/Context.h"
+#include "pipelines/Cascade.h"
+#include "pipelines/Copier.h"
+#include "pipelines/Decimator.h"
+#include "pipelines/Deemphasis.h"
+#include "pipelines/FIR.h"
+#include "pipelines/Polyphase.h"
+#include "pipelines/Quadrature.h"
+#include "pipelines/ShiftDecimator.h"
+
+// Largest block processed in one pass, also the default.
 #define MAX_SAMPLE_ARRAY_SIZE (512 * 1024)
+#define MAX_STAGES 16
+#define MIN_DEPTH 2
+#define MAX_DEPTH 8
+#define MAX_INTERPOLATION 4096
+#define MAX_CHANNELS 16
 
 #define F2B(x) ((x) * sizeof(float))
 #define S2B(x) ((x) * 2 * sizeof(float))
+#define H2B(x) ((x) * 2 * sizeof(uint16_t))
 #define BOF(x) S2B(x->size() / sizeof(float) - 1)
 
 namespace Vulkan::DSP {
     using Taps = std::vector<std::vector<float>>;
 
+    // Per-block parameters, must match the Params block in the shaders.
+    struct Params {
+        uint32_t shifterOffset;
+        uint32_t shifterCount;
+
+        // Input buffers are rings, offsets are positions in the ring of the buffer read or written.
+        struct Stage {
+            uint32_t outputCount;
+            uint32_t outputOffset;
+            // Oldest sample kept from the previous block.
+            uint32_t inputOffset;
+        } stages[MAX_STAGES];
+
+        struct Copy {
+            uint32_t srcOffset;
+            uint32_t dstOffset;
+            uint32_t count;
+        } copies[1 + MAX_STAGES];
+
+        // Which half of the cascade history buffer holds the previous block.
+        uint32_t historyIndex;
+
+        // Rational resampler state at the start of the block.
+        struct Polyphase {
+            uint32_t outputCount;
+            uint32_t offset;
+            uint32_t phase;
+            // Ring position of the first output when the filter input is written.
+            uint32_t outputOffset;
+        } polyphase;
+
+        // Shifter phase at the start of the block and phase increment of each channel.
+        struct Shift {
+            float phi;
+            float omega;
+        } shifts[MAX_CHANNELS];
+
+        // Staging sample the block starts at, blocks read in place may start inside a larger buffer of the caller.
+        uint32_t stagingOffset;
+    };
+
+    // Per-stage layout of the cascade taps and history buffers, must match the Taps block in cascade.comp.
+    struct CascadeFilter {
+        uint32_t tapOffset;
+        uint32_t tapCount;
+        uint32_t historyOffset;
+        uint32_t historySize;
+    };
+
+    // Optional rational resampler after the last decimator stage, taps are interpolation times the rate of its input.
+    struct Resampler {
+        uint32_t interpolation = 1;
+        uint32_t decimation = 1;
+        std::vector<float> taps;
+    };
+
+    // Optional complex FIR filter after the resampler, such as a matched filter, enabled when it has taps. Outputs are decimated by decimation.
+    struct Filter {
+        std::vector<float> taps;
+        uint32_t decimation = 1;
+    };
+
+    // Optional wideband FM demodulator after the decimators, the resampler and the filter, the outputs are then real samples with a zero imaginary part.
+    struct Demodulator {
+        // Sample rate / (2 pi deviation) at its input, the demodulator is enabled when it is not zero.
+        float gain = 0.0f;
+        // Filters of the demodulated samples, each decimating by its factor.
+        Taps taps;
+        std::vector<uint32_t> decimations;
+        // De-emphasis dt / (tau + dt) at the output rate, 1 leaves the samples as they are.
+        float deemphasis = 1.0f;
+    };
+
+    // Buffers of the demodulator stages, shared by all slots like the stage input buffers.
+    struct DemodulatorBuffers {
+        // Written by the last decimator stage or the resampler.
+        std::unique_ptr<Buffer> input;
+        // Last input sample of the previous block of each channel, in two ping-pong halves.
+        std::unique_ptr<Buffer> history;
+        // Taps and input ring of each filter.
+        std::vector<std::unique_ptr<Buffer>> taps;
+        std::vector<std::unique_ptr<Buffer>> rings;
+        // Written by the last filter, and the last de-emphasis output of each channel.
+        std::unique_ptr<Buffer> deemphasisInput;
+        std::unique_ptr<Buffer> deemphasisState;
+    };
+
+    // Per-block dispatch sizes, consumed by vkCmdDispatchIndirect.
+    struct Dispatch {
+        VkDispatchIndirectCommand staging;
+        VkDispatchIndirectCommand stages[MAX_STAGES];
+        VkDispatchIndirectCommand cascade;
+        VkDispatchIndirectCommand polyphase;
+
+        static constexpr VkDeviceSize stagingOffset() { return offsetof(Dispatch, staging); }
+        static constexpr VkDeviceSize cascadeOffset() { return offsetof(Dispatch, cascade); }
+        static constexpr VkDeviceSize polyphaseOffset() { return offsetof(Dispatch, polyphase); }
+        static constexpr VkDeviceSize stageOffset(size_t index) { return offsetof(Dispatch, stages) + index * sizeof(VkDispatchIndirectCommand); }
+    };
+
     struct ShiftDecimator {
+        // Block returned by poll or wait, in the order the blocks were submitted.
+        struct Completion {
+            // Sequence number given to submit.
+            uint64_t sequence = 0;
+            // Slot whose output buffer holds the outputs until a block is submitted to it again.
+            size_t slot = 0;
+            size_t outputCount = 0;
+            // CLOCK_MONOTONIC times in nanoseconds at which the block was submitted and seen complete, the latency seen by the caller.
+            uint64_t submitTime = 0;
+            uint64_t completionTime = 0;
+            // Time the GPU spent running the block in nanoseconds, from the timestamps of its stages.
+            uint64_t gpuTime = 0;
+        };
+
+        // With stage barriers, the stages of a block and consecutive blocks are ordered by barriers in the command buffers,
+        // otherwise the subclass orders them with semaphores between submissions.
+        ShiftDecimator(Context *context, size_t depth, size_t channels, SampleFormat format, size_t maxBlockSize, bool stageBarriers)
+            : context(context), channels(channels), format(format), blockSize(maxBlockSize), stageBarriers(stageBarriers),
+              vkCommandPool(context->device()), vkQueryPool(context->device()), numBuffers(depth) {}
         virtual ~ShiftDecimator() = default;
-        virtual bool process(float *samples, size_t sampleCount, float phi, float omega) = 0;
+        // Shifts the block by phi[c] + omega[c] * i for each channel c, the outputs of all channels follow each other in output.
+        // Samples are in the format given at creation, output may alias them when they are floats.
+        // Without samples the block is already in the staging buffer of the current slot, without output it stays in its output buffer.
+        // Blocks larger than the maximum block size are processed in chunks, which needs both samples and output. Chunks are submitted
+        // to the GPU together, as many at once as there are slots, completing the oldest blocks first to make room for them.
+        // The output is that of the block submitted slotCount() - 1 blocks earlier, flush returns the blocks still in flight.
+        bool process(const void *samples, size_t sampleCount, float *output, size_t &outputCount, const float *phi, const float *omega);
+        // Waits for all blocks in flight and returns their outputs as process does for a single block, output needs flushSize() bytes.
+        bool flush(float *output, size_t &outputCount);
+
+        // Submits a block without waiting for the GPU, samples work as for process. Larger blocks are split into chunks of the maximum block
+        // size with consecutive sequence numbers, submitted together. Each chunk needs a free slot, at most slotCount() blocks may be in flight.
+        bool submit(const void *samples, size_t sampleCount, uint64_t sequence, const float *phi, const float *omega);
+        // Returns the oldest block in flight if the GPU is done with it, completed is false otherwise. Output works as for process.
+        bool poll(float *output, Completion &completion, bool &completed);
+        // Waits for the oldest block in flight, which must have been submitted with sequence, and returns it.
+        bool wait(uint64_t sequence, float *output, Completion &completion);
+        // Blocks submitted and not yet returned.
+        size_t inFlight() const { return pending.size(); }
+        size_t flushSize() const { return pending.size() * outputBufferSize(); }
+
+        // Processes consecutive chunks of at most the maximum block size as process does, submitting them in batches.
+        // Before a chunk is staged in the current slot, getChunk either points samples at it, copies it to the staging buffer of the slot,
+        // or points staging at a buffer of the caller holding it from sample stagingOffset on.
+        using ChunkFunction = std::function<bool(size_t offset, size_t count, const void *&samples, const Buffer *&staging, uint32_t &stagingOffset)>;
+        bool processChunks(size_t sampleCount, float *output, size_t &outputCount, const float *phi, const float *omega, const ChunkFunction &getChunk);
+
+        // Persistently mapped buffers of each ring slot. The current slot receives the next block in its staging buffer,
+        // and its output buffer holds the block read back by the last process call until the next one.
+        size_t slotCount() const { return numBuffers; }
+        size_t currentSlot() const { return bufferIndex; }
+        void *stagingBuffer(size_t slot) const { return pStagingBuffers[slot]; }
+        const float *outputBuffer(size_t slot) const { return (const float *) pOutputBuffers[slot]; }
+
+        SampleFormat sampleFormat() const { return format; }
+        size_t channelCount() const { return channels; }
+        size_t maxBlockSize() const { return blockSize; }
+        size_t stagingSize() const { return sampleSize(format) * blockSize; }
+        // Largest output of a block of sampleCount samples, in bytes.
+        size_t maxOutputSize(size_t sampleCount) const { return S2B(channels * std::max<size_t>((sampleCount + blockSize - 1) / blockSize, 1) * outputSize); }
+        size_t outputBufferSize() const { return S2B(channels * outputSize); }
+        // Samples of a channel in an output buffer, channels follow each other.
+        size_t outputStride() const { return outputSize; }
+
+    protected:
+        // Creates the buffers, pipelines and pools shared by the subclasses, which then create their semaphores.
+        bool initialize(Taps &, Resampler &, Filter &, Demodulator &, bool bakeTaps, bool halfPrecision);
+        // Submits the blocks prepared since the last submission at once, the first of them is block number blockCount.
+        // The command buffers of both stages of each block are in commandBuffers of its slot.
+        virtual bool submitBlocks(size_t count) = 0;
+        // Checks whether the given block number is complete, waiting for it with wait.
+        virtual bool completeBlock(uint64_t block, bool wait, bool &complete) = 0;
+
+        static constexpr size_t groupSize = 64;
+
+        // Final outputs computed by each cascade work group.
+        static constexpr size_t cascadeTileSize = 32;
+
+        void initializeHistory(const Taps &taps);
+        void initializeCascade(const Taps &taps, size_t sharedMemorySize);
+        bool createCascadeBuffers(const Taps &taps, std::unique_ptr<Buffer> &tapsBuffer, std::unique_ptr<Buffer> &historyBuffer);
+        bool initializeResampler(const Taps &taps, const Resampler &resampler);
+        bool createResamplerBuffers(const Taps &taps, const Resampler &resampler, std::unique_ptr<Buffer> &tapsBuffer, std::unique_ptr<Buffer> &inputBuffer) const;
+        bool initializeFilter(const Taps &taps, const Filter &filter);
+        bool createFilterBuffers(const Filter &filter, std::unique_ptr<Buffer> &tapsBuffer, std::unique_ptr<Buffer> &inputBuffer) const;
+        bool initializeDemodulator(const Taps &taps, const Demodulator &demodulator);
+        bool createDemodulatorBuffers(const Demodulator &demodulator, DemodulatorBuffers &buffers) const;
+        size_t prepare(Params *params, Dispatch *dispatch, size_t sampleCount, const float *phi, const float *omega);
+
+        // Samples of a channel in the input buffer of a stage and in the resampler input buffer.
+        uint32_t inputSize(const Taps &taps, size_t stage) const;
+        uint32_t resamplerInputSize(const Taps &taps) const;
+
+        Context * const context;
+
+        // Channels share the input block, each has its own slice of every other buffer.
+        const size_t channels;
+        // Layout of the samples copied to the staging buffer, converted to floats on the GPU.
+        const SampleFormat format;
+        // Largest block processed in one pass, rounded up so that every stage halves it exactly.
+        size_t blockSize;
+        // Samples of a channel in the output buffer.
+        uint32_t outputSize = 0;
+
+        // Number of submitted blocks, not counting those staged.
+        uint64_t blockCount = 0;
+
+        // Outputs of the chunks of a large block, gathered before the channels are put one after another.
+        std::vector<float> chunkOutputs;
+        std::vector<size_t> chunkCounts;
+
+        // Number of samples kept from the previous block for each stage.
+        std::vector<uint32_t> history;
+        // Input samples left over when a stage receives an odd number of samples.
+        std::vector<uint32_t> carry;
+        // Channel slices of the stage input buffers are rings of inputSize() samples, new samples are written after the kept ones
+        // so nothing is moved between blocks. Position of the oldest kept sample, stages inside the cascade have no ring and stay at 0.
+        std::vector<uint32_t> ringOffsets;
+        std::vector<uint32_t> ringSizes;
+
+        // Stages from cascadeStage onwards run in a single shared memory dispatch, none if past the last stage.
+        size_t cascadeStage = 0;
+        // Shared memory samples of the two ping-pong windows.
+        uint32_t cascadeWindows[2] = {};
+        // Samples of the cascade history of a channel.
+        uint32_t cascadeHistorySize = 0;
+        uint32_t historyIndex = 0;
+
+        // Resampler is enabled when it has any taps, they are split into interpolation phases.
+        uint32_t interpolation = 1;
+        uint32_t decimation = 1;
+        uint32_t tapsPerPhase = 0;
+        // Resampler position in its input buffer and phase for the next block.
+        uint32_t polyphaseOffset = 0;
+        uint32_t polyphasePhase = 0;
+        // Resampler input buffer is a ring of resamplerInputSize() samples, polyphaseOffset counts from its oldest kept sample.
+        uint32_t polyphaseRingOffset = 0;
+        uint32_t polyphaseRingSize = 0;
+
+        // Filter consuming samples as the decimator stages do, its input buffer is a ring of ringSize samples.
+        struct RingFilter {
+            uint32_t decimation;
+            uint32_t history;
+            uint32_t carry;
+            uint32_t ringOffset;
+            uint32_t ringSize;
+
+            // Ring position of the first new sample, after those kept from the previous block.
+            uint32_t writeOffset() const { return (ringOffset + history + carry) % ringSize; }
+        };
+
+        // Samples of a channel written by the last decimator stage or the resampler, the output size without a filter or a demodulator.
+        uint32_t decimatorOutputSize = 0;
+        // Filter runs in the stage after the decimator stages, none if 0, the first stage is always a decimator.
+        size_t filterStage = 0;
+        RingFilter filterState = {};
+        // Samples of a channel in the demodulator input.
+        uint32_t demodulatorInputSize = 0;
+        // Demodulator stages follow the decimator stages and the filter from demodulatorStage on, the quadrature demodulator,
+        // each of its filters and the de-emphasis. None if 0.
+        size_t demodulatorStage = 0;
+        std::vector<RingFilter> demodulatorFilters;
+
+        // Stages are ordered by barriers recorded in the command buffers, see the constructor.
+        const bool stageBarriers;
+
+        // Command buffers are allocated from a pool of the instance, command pools can't be shared between threads.
+        VulkanCommandPool vkCommandPool;
+        // Timestamps of the stages of each slot.
+        VulkanQueryPool vkQueryPool;
+
+        const size_t numBuffers;
+        size_t bufferIndex = 0;
+
+        static constexpr size_t numStages = 2;
+
+        // Stage 1 runs the shifter and the first decimator, stage 2 the remaining stages. Recorded once per slot,
+        // stage 1 again when its staging buffer changes.
+        std::unique_ptr<VulkanCommandBuffer> commandBuffers[MAX_DEPTH][numStages];
+
+    private:
+        template <typename T>
+        using unique_ptrs = std::vector<std::unique_ptr<T>>;
+
+        // Prepares the block in the current slot and advances to the next slot. The samples are copied to the staging buffer of the slot,
+        // or read from staging, a buffer of the caller, from sample stagingOffset on.
+        bool prepareBlock(const Buffer *staging, uint32_t stagingOffset, const void *samples, size_t sampleCount, size_t &outputCount,
+                          const float *phi, const float *omega);
+        bool recordCommandBuffers();
+        void recordStages(VkCommandBuffer commandBuffer, size_t first, size_t last);
+        void recordResampler(VkCommandBuffer commandBuffer);
+        void recordFilter(VkCommandBuffer commandBuffer);
+        void recordDemodulator(VkCommandBuffer commandBuffer);
+        // GPU time of the block in the slot, from the start of stage 1 to the end of stage 2.
+        uint64_t readGpuTime(size_t slot);
+
+        unique_ptrs<Buffer> tapBuffers;
+        unique_ptrs<Buffer> inputBuffers;
+
+        std::unique_ptr<Buffer> cascadeTapsBuffer;
+        std::unique_ptr<Buffer> cascadeHistoryBuffer;
+
+        std::unique_ptr<Buffer> polyphaseTapsBuffer;
+        std::unique_ptr<Buffer> polyphaseInputBuffer;
+
+        std::unique_ptr<Buffer> filterTapsBuffer;
+        std::unique_ptr<Buffer> filterInputBuffer;
+
+        DemodulatorBuffers demodulatorBuffers;
+
+        std::unique_ptr<Buffer> paramsBuffers[MAX_DEPTH];
+        std::unique_ptr<Buffer> dispatchBuffers[MAX_DEPTH];
+        std::unique_ptr<Buffer> stagingBuffers[MAX_DEPTH];
+        std::unique_ptr<Buffer> outputBuffers[MAX_DEPTH];
+
+        Params *pParamsBuffers[MAX_DEPTH];
+        Dispatch *pDispatchBuffers[MAX_DEPTH];
+        void *pStagingBuffers[MAX_DEPTH];
+        void *pOutputBuffers[MAX_DEPTH];
+
+        // Generation of the buffer the first stage of each slot reads new samples from, its own staging buffer unless given one by the caller.
+        uint64_t boundStagingGenerations[MAX_DEPTH];
+
+        std::unique_ptr<Pipelines::ShiftDecimator> shiftDecimators[MAX_DEPTH];
+        // Decimators of the stages between the first one and the cascade.
+        unique_ptrs<Pipelines::Decimator> decimators[MAX_DEPTH];
+        // Copies the new samples still needed by the next block into the first input ring.
+        std::unique_ptr<Pipelines::Copier> stagingCopiers[MAX_DEPTH];
+        std::unique_ptr<Pipelines::Cascade> cascades[MAX_DEPTH];
+        std::unique_ptr<Pipelines::Polyphase> polyphases[MAX_DEPTH];
+        std::unique_ptr<Pipelines::FIR> firs[MAX_DEPTH];
+        // Quadrature demodulator, its filters and the de-emphasis, only with a demodulator.
+        std::unique_ptr<Pipelines::Quadrature> quadratures[MAX_DEPTH];
+        unique_ptrs<Pipelines::FIR> filters[MAX_DEPTH];
+        std::unique_ptr<Pipelines::Deemphasis> deemphases[MAX_DEPTH];
+
+        struct Counters {
+            const bool enable = true;
+
+            int counter = 0;
+
+            // Time from submitting a block to seeing it complete.
+            timespec submitTimestamps[MAX_DEPTH];
+            unsigned long totalTimeMin = LONG_MAX;
+            unsigned long totalTimeMax = 0;
+            unsigned long totalTimeSum = 0;
+
+            struct Stages {
+                float timeMin = MAXFLOAT;
+                float timeMax = 0.0f;
+                float timeSum = 0.0f;
+            } stages[numStages];
+
+            timespec waitTimestamp[2];
+            unsigned long waitTimeMin = LONG_MAX;
+            unsigned long waitTimeMax = 0;
+            unsigned long waitTimeSum = 0;
+
+            inline void getTime(timespec &ts) const {
+                if (enable) {
+                    clock_gettime(CLOCK_MONOTONIC, &ts);
+                }
+            }
+        } counters;
+
+        void updateCounters(size_t slot, const uint64_t *values);
+
+        // Prepares a block in the current slot without submitting it, staged blocks are submitted together.
+        bool stageBlock(const Buffer *staging, uint32_t stagingOffset, const void *samples, size_t sampleCount, uint64_t sequence,
+                        const float *phi, const float *omega);
+        bool submitStaged();
+        bool completePending(bool wait, float *output, Completion &completion, bool &completed);
+        bool completeOldest(float *output, size_t &outputCount);
+        size_t prepareDemodulator(Params *params, Dispatch *dispatch, size_t inputCount);
+        // Sets up the stage of a filter for inputCount new samples and advances its ring, returns the output count.
+        size_t prepareRingFilter(RingFilter &ringFilter, size_t stage, size_t inputCount, uint32_t outputOffset, Params *params, Dispatch *dispatch);
+        // Shifter phase at the sample at offset.
+        void chunkPhase(const float *phi, const float *omega, size_t offset, float *chunkPhi) const;
+
+        // Calls outputBlock for each of the blocks and puts the outputs of each channel one after another.
+        using BlockFunction = std::function<bool(size_t index, float *output, size_t &outputCount)>;
+        bool gatherBlocks(size_t blocks, float *output, size_t &outputCount, const BlockFunction &outputBlock);
+
+        // Blocks in flight, oldest first, a slot is free once its block was returned. The last staged ones are not submitted yet.
+        std::deque<Completion> pending;
+        size_t staged = 0;
     };
 }
@@ -2,317 +2,131 @@
 #include "vulkan/Utils.h"
 
 namespace Vulkan::DSP {
-    std::unique_ptr<ShiftDecimatorMultiQueue> ShiftDecimatorMultiQueue::create(Context *context, Taps &&taps) {
-        if (context == nullptr) {
+    std::unique_ptr<ShiftDecimatorMultiQueue> ShiftDecimatorMultiQueue::create(Context *context, Taps &&taps, Resampler &&resampler, Filter &&filter, Demodulator &&demodulator,
+                                                                               size_t depth, size_t channels, SampleFormat format, size_t maxBlockSize, bool bakeTaps, bool halfPrecision) {
+        if (context == nullptr || !context->supportsTimelineSemaphores() || context->queueCount() < numQueues || depth < MIN_DEPTH || depth > MAX_DEPTH || channels < 1 || channels > MAX_CHANNELS ||
+            maxBlockSize < 1 || maxBlockSize > MAX_SAMPLE_ARRAY_SIZE) {
             return nullptr;
         }
-        auto processor = std::make_unique<ShiftDecimatorMultiQueue>(context);
-        const bool success = processor->initialize(taps);
+        auto processor = std::make_unique<ShiftDecimatorMultiQueue>(context, depth, channels, format, maxBlockSize);
+        const bool success = processor->initialize(taps, resampler, filter, demodulator, bakeTaps, halfPrecision);
         return success ? std::move(processor) : nullptr;
     }
 
-    bool ShiftDecimatorMultiQueue::initialize(Taps &taps) {
-        for (size_t i = 0; i < taps.size(); i++) {
-            auto buffer = Buffer::create(
-                    context, F2B(taps[i].size()),
-                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-            VK_CHECK(buffer != nullptr);
-            buffer->copyFrom(taps[i].data(), 0, F2B(taps[i].size()));
-            tapBuffers.emplace_back(std::move(buffer));
+    bool ShiftDecimatorMultiQueue::initialize(Taps &taps, Resampler &resampler, Filter &filter, Demodulator &demodulator, bool bakeTaps, bool halfPrecision) {
+        VK_CHECK(ShiftDecimator::initialize(taps, resampler, filter, demodulator, bakeTaps, halfPrecision));
 
-            buffer = Buffer::create(
-                    context, S2B(taps[i].size() - 1 + (MAX_SAMPLE_ARRAY_SIZE >> i)),
-                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-            VK_CHECK(buffer != nullptr);
-            inputBuffers.emplace_back(std::move(buffer));
-        }
-
-        for (size_t i = 0; i < numBuffers; i++) {
-            paramsBuffers[i] = Buffer::create(
-                    context, paramsBufferSize,
-                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-            VK_CHECK(paramsBuffers[i] != nullptr);
-
-            stagingBuffers[i] = Buffer::create(
-                    context, S2B(MAX_SAMPLE_ARRAY_SIZE),
-                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-            VK_CHECK(stagingBuffers[i] != nullptr);
-
-            outputBuffers[i] = Buffer::create(
-                    context, S2B(MAX_SAMPLE_ARRAY_SIZE >> tapBuffers.size()),
-                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-            VK_CHECK(outputBuffers[i] != nullptr);
-
-            pParamsBuffers[i] = nullptr;
-            pStagingBuffers[i] = nullptr;
-            pOutputBuffers[i] = nullptr;
-
-            shifters[i] = Pipelines::Shifter::create(context, groupSize, paramsBuffers[i].get(), stagingBuffers[i].get());
-            VK_CHECK(shifters[i] != nullptr);
-
-            for (size_t j = 0; j < taps.size() - 1; j++) {
-                auto decimator = Pipelines::Decimator::create(context, groupSize, j, paramsBuffers[i].get(),
-                                                              tapBuffers[j].get(), inputBuffers[j].get(), inputBuffers[j + 1].get());
-                VK_CHECK(decimator != nullptr);
-                decimators[i].emplace_back(std::move(decimator));
-            }
-
-            auto decimator = Pipelines::Decimator::create(context, groupSize, taps.size() - 1, paramsBuffers[i].get(),
-                                                          tapBuffers[taps.size() - 1].get(), inputBuffers[taps.size() - 1].get(), outputBuffers[i].get());
-            VK_CHECK(decimator != nullptr);
-            decimators[i].emplace_back(std::move(decimator));
-
-            fences[i] = std::make_unique<VulkanFence>(context->device());
-            VK_CHECK(context->createFence(*fences[i]));
-
-            for (size_t j = 0; j < 2; j++) {
-                semaphores[i][j] = std::make_unique<VulkanSemaphore>(context->device());
-                VK_CHECK(context->createSemaphore(*semaphores[i][j]));
-            }
+        for (auto &timeline: timelines) {
+            timeline = std::make_unique<VulkanSemaphore>(context->device());
+            VK_CHECK(context->createTimelineSemaphore(*timeline));
         }
 
         return true;
     }
 
-    bool ShiftDecimatorMultiQueue::process(float *samples, size_t sampleCount, float phi, float omega) {
-        const auto otherBufferIndex = (bufferIndex + 1) % numBuffers;
-
-        counters.getTime(counters.totalTimestamp[0]);
-
-        // Update parameters.
-        if (pParamsBuffers[bufferIndex] == nullptr) {
-            VK_CHECK(paramsBuffers[bufferIndex]->map((void **) &pParamsBuffers[bufferIndex], 0, paramsBufferSize));
-
-            ((uint32_t *) pParamsBuffers[bufferIndex])[2] = 0;
-
-            for (size_t i = 0; i < tapBuffers.size() - 1; i++) {
-                ((uint32_t *) pParamsBuffers[bufferIndex])[3 + i] = tapBuffers[i + 1]->size() / sizeof(float) - 1;
-            }
+    bool ShiftDecimatorMultiQueue::completeBlock(uint64_t block, bool wait, bool &complete) {
+        // Wait for the last stage of the block, or only check whether it is done.
+        const VkSemaphore timeline = *timelines[block % numQueues];
+        const uint64_t value = numStages * block + numStages;
 
-            ((uint32_t *) pParamsBuffers[bufferIndex])[3 + tapBuffers.size() - 1] = 0;
+        if (wait) {
+            VK_CHECK(context->waitSemaphore(timeline, value));
+            complete = true;
+        } else {
+            VK_CHECK(context->semaphoreReached(timeline, value, complete));
         }
-
-        ((float *) pParamsBuffers[bufferIndex])[0] = phi;
-        ((float *) pParamsBuffers[bufferIndex])[1] = omega;
-
-        // Copy samples to staging buffer.
-        if (pStagingBuffers[bufferIndex] == nullptr) {
-            VK_CHECK(stagingBuffers[bufferIndex]->map(&pStagingBuffers[bufferIndex], 0, S2B(sampleCount)));
-        }
-
-        memcpy(pStagingBuffers[bufferIndex], samples, S2B(sampleCount));
-
-        // Stage 1 - shifter.
-        if (commandBuffers[bufferIndex][0] == nullptr) {
-            commandBuffers[bufferIndex][0] = std::make_unique<VulkanCommandBuffer>(context->device(), context->commandPool());
-            auto *commandBuffer = commandBuffers[bufferIndex][0].get();
-            // Begin command buffer.
-            VK_CHECK(context->createCommandBuffer(*commandBuffer));
-            VK_CHECK(Context::beginCommandBuffer(*commandBuffer));
-            // Reset timestamps.
-            vkCmdResetQueryPool(*commandBuffer, context->queryPool(), 6 * bufferIndex, 6);
-            // Get start timestamp.
-            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->queryPool(), 6 * bufferIndex + 0);
-            // Run shifter.
-            shifters[bufferIndex]->recordComputeCommands(*commandBuffer, sampleCount);
-            // Wait for shifter to complete.
-            Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
-            // Get end timestamp.
-            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->queryPool(), 6 * bufferIndex + 1);
-            // End command buffer
-            VK_CALL(vkEndCommandBuffer, *commandBuffer);
-        }
-
-        // Stage 2 - first decimator.
-        if (commandBuffers[bufferIndex][1] == nullptr) {
-            commandBuffers[bufferIndex][1] = std::make_unique<VulkanCommandBuffer>(context->device(), context->commandPool());
-            auto *commandBuffer = commandBuffers[bufferIndex][1].get();
-            // Begin command buffer.
-            VK_CHECK(context->createCommandBuffer(*commandBuffer));
-            VK_CHECK(Context::beginCommandBuffer(*commandBuffer));
-            // Get start timestamp.
-            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->queryPool(), 6 * bufferIndex + 2);
-            // Copy from staging buffer to input buffer.
-            const VkBufferCopy stagingCopy = {.srcOffset = 0, .dstOffset = BOF(tapBuffers[0]), .size = S2B(sampleCount)};
-            vkCmdCopyBuffer(*commandBuffer, stagingBuffers[bufferIndex]->handle(), inputBuffers[0]->handle(), 1, &stagingCopy);
-            // Run decimator.
-            decimators[bufferIndex][0]->recordComputeCommands(*commandBuffer, sampleCount >> 1);
-            // Wait for decimator to complete.
-            Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
-            // Update input buffer.
-            const VkBufferCopy bufferCopy = {.srcOffset = S2B(sampleCount), .dstOffset = 0, .size = BOF(tapBuffers[0])};
-            vkCmdCopyBuffer(*commandBuffer, inputBuffers[0]->handle(), inputBuffers[0]->handle(), 1, &bufferCopy);
-            // Get end timestamp.
-            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->queryPool(), 6 * bufferIndex + 3);
-            // End command buffer
-            VK_CALL(vkEndCommandBuffer, *commandBuffer);
-        }
-
-        // Stage 3 - remaining decimators.
-        if (commandBuffers[bufferIndex][2] == nullptr) {
-            commandBuffers[bufferIndex][2] = std::make_unique<VulkanCommandBuffer>(context->device(), context->commandPool());
-            auto *commandBuffer = commandBuffers[bufferIndex][2].get();
-            // Begin command buffer.
-            VK_CHECK(context->createCommandBuffer(*commandBuffer));
-            VK_CHECK(Context::beginCommandBuffer(*commandBuffer));
-            // Get start timestamp.
-            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->queryPool(), 6 * bufferIndex + 4);
-            for (size_t i = 1; i < tapBuffers.size(); i++) {
-                // Run decimator.
-                decimators[bufferIndex][i]->recordComputeCommands(*commandBuffer, sampleCount >> (i + 1));
-                // Wait for decimator to complete.
-                Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
-                // Update input buffer.
-                const VkBufferCopy bufferUpdate = {.srcOffset = S2B(sampleCount >> i), .dstOffset = 0, .size = BOF(tapBuffers[i])};
-                vkCmdCopyBuffer(*commandBuffer, inputBuffers[i]->handle(), inputBuffers[i]->handle(), 1, &bufferUpdate);
-            }
-            // Get end timestamp.
-            vkCmdWriteTimestamp(*commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->queryPool(), 6 * bufferIndex + 5);
-            // End command buffer
-            VK_CALL(vkEndCommandBuffer, *commandBuffer);
-        }
-
-        // Reset fence.
-        VK_CALL(vkResetFences, context->device(), 1, *fences[bufferIndex]);
-        // Submit command buffers.
-        VK_CHECK(Submit());
-
-        // Wait for other queue to complete.
-        counters.getTime(counters.waitTimestamp[0]);
-        VK_CALL(vkWaitForFences, context->device(), 1, *fences[otherBufferIndex], true, -1ull);
-        counters.getTime(counters.waitTimestamp[1]);
-
-        if (pOutputBuffers[otherBufferIndex] == nullptr) {
-            VK_CHECK(outputBuffers[otherBufferIndex]->map(&pOutputBuffers[otherBufferIndex], 0, S2B(sampleCount >> tapBuffers.size())));
-        }
-
-        // Copy samples from output buffer.
-        memcpy(samples, pOutputBuffers[otherBufferIndex], S2B(sampleCount >> tapBuffers.size()));
-
-        // Swap buffers.
-        bufferIndex = otherBufferIndex;
-
-        if (firstSubmit) {
-            firstSubmit = false;
-        }
-
-        counters.getTime(counters.totalTimestamp[1]);
-
-        // Update timestamp stats.
-        if (counters.enable) {
-            updateCounters();
-        }
-
         return true;
     }
 
-    bool ShiftDecimatorMultiQueue::Submit() {
-        const auto otherBufferIndex = (bufferIndex + 1) % numBuffers;
-        static const VkFlags stageFlags = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    bool ShiftDecimatorMultiQueue::submitBlocks(size_t count) {
+        static const VkFlags stageFlags[2] = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT};
 
-        const std::vector<VkSubmitInfo> submitInfo = {
-                {
-                        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                        .pNext = nullptr,
-                        .waitSemaphoreCount = 0,
-                        .pWaitSemaphores = nullptr,
-                        .pWaitDstStageMask = &stageFlags,
-                        .commandBufferCount = 1,
-                        .pCommandBuffers = *commandBuffers[bufferIndex][0],
-                        .signalSemaphoreCount = 0,
-                        .pSignalSemaphores = nullptr,
-                },
-                {
-                        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        const VkSemaphore semaphores[numQueues] = {*timelines[0], *timelines[1]};
+
+        // Value signalled by a stage of a block, waiting for the value of a block before the first one never waits.
+        const auto signalValue = [](uint64_t block, size_t stage) {
+            return numStages * block + stage + 1;
+        };
+        const auto waitValue = [&](uint64_t block, uint64_t before, size_t stage) {
+            return block >= before ? signalValue(block - before, stage) : 0;
+        };
+
+        // With a single decimator stage, stage 1 writes the buffers read by stage 2 of the previous block.
+        const size_t stage1Waits = history.size() > 1 ? 0 : 1;
+
+        // Each stage waits for two values, of its own queue and of the other one, and signals one.
+        VkSemaphore waitSemaphores[MAX_DEPTH][numStages][2];
+        uint64_t waitValues[MAX_DEPTH][numStages][2];
+        uint64_t signalValues[MAX_DEPTH][numStages];
+        VkTimelineSemaphoreSubmitInfo timelineSubmitInfos[MAX_DEPTH][numStages];
+        VkCommandBuffer submitCommandBuffers[MAX_DEPTH][numStages];
+        // Submits of the blocks running on each queue.
+        VkSubmitInfo submitInfos[numQueues][MAX_DEPTH * numStages];
+        uint32_t submitCounts[numQueues] = {};
+
+        for (size_t i = 0; i < count; i++) {
+            const size_t slot = (bufferIndex + numBuffers - count + i) % numBuffers;
+            const uint64_t block = blockCount + i;
+
+            const size_t queueIndex = block % numQueues;
+            const VkSemaphore timeline = semaphores[queueIndex];
+            const VkSemaphore otherTimeline = semaphores[(block + 1) % numQueues];
+
+            // Stage 1 waits for stage 1 of the previous block, which wrote the history of the first input ring, and for stage 2 of the
+            // block before that, which read the part of the second input ring it writes. The second ring holds two blocks of samples,
+            // so stage 1 overlaps stage 2 of the previous block.
+            waitSemaphores[i][0][0] = otherTimeline;
+            waitValues[i][0][0] = waitValue(block, 1, stage1Waits);
+            waitSemaphores[i][0][1] = timeline;
+            waitValues[i][0][1] = waitValue(block, 2, 1);
+
+            // Stage 2 waits for stage 1 and for stage 2 of the previous block, they share the remaining buffers.
+            waitSemaphores[i][1][0] = timeline;
+            waitValues[i][1][0] = signalValue(block, 0);
+            waitSemaphores[i][1][1] = otherTimeline;
+            waitValues[i][1][1] = waitValue(block, 1, 1);
+
+            for (size_t j = 0; j < numStages; j++) {
+                signalValues[i][j] = signalValue(block, j);
+                timelineSubmitInfos[i][j] = {
+                        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
                         .pNext = nullptr,
-                        .waitSemaphoreCount = firstSubmit ? 0 : 1u,
-                        .pWaitSemaphores = (VkSemaphore *) *semaphores[otherBufferIndex][0],
-                        .pWaitDstStageMask = &stageFlags,
-                        .commandBufferCount = 1,
-                        .pCommandBuffers = *commandBuffers[bufferIndex][1],
-                        .signalSemaphoreCount = 1,
-                        .pSignalSemaphores = (VkSemaphore *) *semaphores[bufferIndex][0],
-                },
-                {
+                        .waitSemaphoreValueCount = 2,
+                        .pWaitSemaphoreValues = waitValues[i][j],
+                        .signalSemaphoreValueCount = 1,
+                        .pSignalSemaphoreValues = &signalValues[i][j],
+                };
+                submitCommandBuffers[i][j] = *commandBuffers[slot][j];
+                submitInfos[queueIndex][submitCounts[queueIndex]++] = {
                         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                        .pNext = nullptr,
-                        .waitSemaphoreCount = firstSubmit ? 0 : 1u,
-                        .pWaitSemaphores = (VkSemaphore *) *semaphores[otherBufferIndex][1],
-                        .pWaitDstStageMask = &stageFlags,
+                        .pNext = &timelineSubmitInfos[i][j],
+                        .waitSemaphoreCount = 2,
+                        .pWaitSemaphores = waitSemaphores[i][j],
+                        .pWaitDstStageMask = stageFlags,
                         .commandBufferCount = 1,
-                        .pCommandBuffers = *commandBuffers[bufferIndex][2],
+                        .pCommandBuffers = &submitCommandBuffers[i][j],
                         .signalSemaphoreCount = 1,
-                        .pSignalSemaphores = (VkSemaphore *) *semaphores[bufferIndex][1],
-                }
-        };
-        VK_CALL(vkQueueSubmit, context->queue(bufferIndex), submitInfo.size(), submitInfo.data(), *fences[bufferIndex]);
-
-        return true;
-    }
-
-    void ShiftDecimatorMultiQueue::updateCounters() {
-        auto delta = (counters.waitTimestamp[1].tv_sec - counters.waitTimestamp[0].tv_sec) * 1000000L +
-                     (counters.waitTimestamp[1].tv_nsec - counters.waitTimestamp[0].tv_nsec) / 1000L;
-        counters.fenceWaitTimeMin = std::min(counters.fenceWaitTimeMin, (unsigned long) delta);
-        counters.fenceWaitTimeMax = std::max(counters.fenceWaitTimeMax, (unsigned long) delta);
-        counters.fenceWaitTimeSum = counters.fenceWaitTimeSum + delta;
-
-        delta = (counters.totalTimestamp[1].tv_sec - counters.totalTimestamp[0].tv_sec) * 1000000L +
-                (counters.totalTimestamp[1].tv_nsec - counters.totalTimestamp[0].tv_nsec) / 1000L;
-        counters.totalTimeMin = std::min(counters.totalTimeMin, (unsigned long) delta);
-        counters.totalTimeMax = std::max(counters.totalTimeMax, (unsigned long) delta);
-        counters.totalTimeSum = counters.totalTimeSum + delta;
-
-        uint64_t values[12];
-        vkGetQueryPoolResults(context->device(), context->queryPool(),
-                              6 * bufferIndex, 6, sizeof(values), values, 2 * sizeof(uint64_t),
-                              VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
-
-        for (size_t j = 0; j < 3; j++) {
-            if (values[4 * j + 1] != 0 && values[4 * j + 3] != 0) {
-                const auto t0 = values[4 * j + 0];
-                const auto t1 = values[4 * j + 2];
-                const auto commandTime = float(t1 - t0) * context->timestampPeriod() / 1000.0f;
-                counters.stages[j].timeMin = std::min(counters.stages[j].timeMin, commandTime);
-                counters.stages[j].timeMax = std::max(counters.stages[j].timeMax, commandTime);
-                counters.stages[j].timeSum = counters.stages[j].timeSum + commandTime;
+                        .pSignalSemaphores = &semaphores[queueIndex],
+                };
             }
         }
 
-        if (++counters.counter == 120) {
-            LOGD("DSP "
-                 "stage 1: %4.0fus / %4.0fus / %4.0fus, "
-                 "stage 2: %4.0fus / %4.0fus / %4.0fus, "
-                 "stage 3: %4.0fus / %4.0fus / %4.0fus, "
-                 "wait: %4luus / %4luus / %4luus, "
-                 "total: %4luus / %4luus / %4luus",
-                 counters.stages[0].timeMin, counters.stages[0].timeSum / counters.counter, counters.stages[0].timeMax,
-                 counters.stages[1].timeMin, counters.stages[1].timeSum / counters.counter, counters.stages[1].timeMax,
-                 counters.stages[2].timeMin, counters.stages[2].timeSum / counters.counter, counters.stages[2].timeMax,
-                 counters.fenceWaitTimeMin, counters.fenceWaitTimeSum / counters.counter, counters.fenceWaitTimeMax,
-                 counters.totalTimeMin, counters.totalTimeSum / counters.counter, counters.totalTimeMax);
-
-            for (auto &stage: counters.stages) {
-                stage.timeMin = MAXFLOAT;
-                stage.timeMax = 0.0f;
-                stage.timeSum = 0.0f;
+        // One submission per queue, starting with the queue of the first block. Blocks on one queue may wait for
+        // values of the other queue signalled by a later submission, which timeline semaphores allow.
+        for (size_t i = 0; i < numQueues; i++) {
+            const size_t queueIndex = (blockCount + i) % numQueues;
+            if (submitCounts[queueIndex] != 0) {
+                VK_CHECK(context->submit(queueIndex, submitCounts[queueIndex], submitInfos[queueIndex], VK_NULL_HANDLE));
             }
-
-            counters.totalTimeMin = counters.fenceWaitTimeMin = LONG_MAX;
-            counters.totalTimeMax = counters.fenceWaitTimeMax = 0;
-            counters.totalTimeSum = counters.fenceWaitTimeSum = 0;
-
-            counters.counter = 0;
         }
+
+        return true;
     }
 
     ShiftDecimatorMultiQueue::~ShiftDecimatorMultiQueue() {
-        context->queueWaitIdle(0);
-        context->queueWaitIdle(1);
+        // Stage 2 of each block waits for stage 2 of the one before it, so the last block is the last to complete.
+        if (blockCount != 0 && timelines[(blockCount - 1) % numQueues] != nullptr) {
+            context->waitSemaphore(*timelines[(blockCount - 1) % numQueues], numStages * blockCount);
+        }
     }
 }
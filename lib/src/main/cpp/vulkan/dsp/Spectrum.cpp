@@ -0,0 +1,202 @@
+#include "Spectrum.h"
+#include "vulkan/Utils.h"
+
+#include <cmath>
+
+namespace Vulkan::DSP {
+    std::unique_ptr<Spectrum> Spectrum::create(Context *context, size_t maxSize) {
+        if (context == nullptr || maxSize < MIN_FFT_SIZE || maxSize > MAX_FFT_SIZE || (maxSize & (maxSize - 1)) != 0) {
+            return nullptr;
+        }
+        auto processor = std::make_unique<Spectrum>(context, maxSize);
+        const bool success = processor->initialize();
+        return success ? std::move(processor) : nullptr;
+    }
+
+    bool Spectrum::initialize() {
+        // Blocks ping-pong between two halves of shared memory.
+        blockSize = maxBlockSize;
+        while (blockSize > MIN_FFT_SIZE && 2 * S2B(blockSize) > context->maxSharedMemorySize()) {
+            blockSize /= 2;
+        }
+        VK_CHECK(2 * S2B(blockSize) <= context->maxSharedMemorySize());
+
+        paramsBuffer = Buffer::create(
+                context, sizeof(SpectrumParams),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(paramsBuffer != nullptr);
+
+        stagingBuffer = Buffer::create(
+                context, S2B(maxSize),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        VK_CHECK(stagingBuffer != nullptr);
+
+        workBuffer = Buffer::create(
+                context, S2B(maxSize),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK(workBuffer != nullptr);
+
+        // Averaged power and peak level.
+        stateBuffer = Buffer::create(
+                context, F2B(2 * maxSize),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_CHECK(stateBuffer != nullptr);
+
+        // Spectrum and peaks in dB.
+        outputBuffer = Buffer::create(
+                context, F2B(2 * maxSize),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(outputBuffer != nullptr);
+
+        VK_CHECK(paramsBuffer->map((void **) &pParamsBuffer, 0, sizeof(SpectrumParams)));
+        VK_CHECK(stagingBuffer->map(&pStagingBuffer, 0, stagingBuffer->size()));
+        VK_CHECK(outputBuffer->map(&pOutputBuffer, 0, outputBuffer->size()));
+
+        VK_CHECK(context->createFence(vkFence));
+        VK_CHECK(context->createCommandPool(vkCommandPool));
+
+        return true;
+    }
+
+    Spectrum::Plan *Spectrum::getPlan(size_t size) {
+        const auto bits = (size_t) std::log2(size);
+
+        if (plans[bits] == nullptr) {
+            auto plan = std::make_unique<Plan>();
+            if (!createPlan(*plan, size)) {
+                return nullptr;
+            }
+            plans[bits] = std::move(plan);
+        }
+
+        return plans[bits].get();
+    }
+
+    bool Spectrum::createPlan(Plan &plan, size_t size) {
+        // Radix-4 passes leave a power of 4 blocks to transform in shared memory.
+        size_t block = size;
+        size_t passCount = 0;
+        while (block > blockSize) {
+            block /= 4;
+            passCount++;
+        }
+
+        // Twiddle factors exp(-2 pi i m / size), the radix-4 butterflies use m up to 3 / 4 of the size.
+        std::vector<float> twiddles(2 * (3 * size / 4));
+        for (size_t m = 0; m < 3 * size / 4; m++) {
+            const double angle = -2.0 * M_PI * (double) m / (double) size;
+            twiddles[2 * m + 0] = (float) std::cos(angle);
+            twiddles[2 * m + 1] = (float) std::sin(angle);
+        }
+
+        plan.twiddlesBuffer = Buffer::create(
+                context, F2B(twiddles.size()),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(plan.twiddlesBuffer != nullptr);
+        VK_CHECK(plan.twiddlesBuffer->copyFrom(twiddles.data(), 0, F2B(twiddles.size())));
+
+        const std::vector<float> window(size, 1.0f);
+
+        plan.windowBuffer = Buffer::create(
+                context, F2B(size),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VK_CHECK(plan.windowBuffer != nullptr);
+        VK_CHECK(plan.windowBuffer->copyFrom(window.data(), 0, F2B(size)));
+
+        // The first pass applies the window while reading the staging buffer, the others work in place.
+        if (passCount > 0) {
+            plan.firstPass = Pipelines::FFTPass::create(context, groupSize, size, true, plan.twiddlesBuffer.get(), plan.windowBuffer.get(),
+                                                        stagingBuffer.get(), workBuffer.get());
+            VK_CHECK(plan.firstPass != nullptr);
+        }
+
+        if (passCount > 1) {
+            plan.pass = Pipelines::FFTPass::create(context, groupSize, size, false, plan.twiddlesBuffer.get(), plan.windowBuffer.get(),
+                                                   workBuffer.get(), workBuffer.get());
+            VK_CHECK(plan.pass != nullptr);
+        }
+
+        plan.fft = Pipelines::FFT::create(context, std::min(block / 4, groupSize), size, block, passCount == 0,
+                                          paramsBuffer.get(), plan.twiddlesBuffer.get(), plan.windowBuffer.get(),
+                                          passCount == 0 ? stagingBuffer.get() : workBuffer.get(), stateBuffer.get(), outputBuffer.get());
+        VK_CHECK(plan.fft != nullptr);
+
+        plan.commandBuffer = std::make_unique<VulkanCommandBuffer>(context->device(), vkCommandPool);
+        auto *commandBuffer = plan.commandBuffer.get();
+        // Begin command buffer.
+        VK_CHECK(context->createCommandBuffer(vkCommandPool, *commandBuffer));
+        VK_CHECK(Context::beginCommandBuffer(*commandBuffer));
+        // Run radix-4 passes.
+        for (size_t i = 0, span = size; i < passCount; i++, span /= 4) {
+            if (i == 0) {
+                plan.firstPass->recordComputeCommands(*commandBuffer, span);
+            } else {
+                plan.pass->recordComputeCommands(*commandBuffer, span);
+            }
+            // Wait for pass to complete.
+            Context::addStageBarrier(*commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+        // Run block transforms and update the spectrum.
+        plan.fft->recordComputeCommands(*commandBuffer);
+        // End command buffer
+        VK_CALL(vkEndCommandBuffer, *commandBuffer);
+
+        return true;
+    }
+
+    bool Spectrum::setWindow(const std::vector<float> &window) {
+        const size_t size = window.size();
+        VK_CHECK(size >= MIN_FFT_SIZE && size <= maxSize && (size & (size - 1)) == 0);
+
+        Plan *plan = getPlan(size);
+        VK_CHECK(plan != nullptr);
+
+        // The previous frame has completed, the window buffer is not in use.
+        VK_CHECK(plan->windowBuffer->copyFrom(window.data(), 0, F2B(size)));
+
+        return true;
+    }
+
+    bool Spectrum::process(const float *samples, size_t size, float alpha, bool reset, float *spectrum, float *peaks) {
+        VK_CHECK(size >= MIN_FFT_SIZE && size <= maxSize && (size & (size - 1)) == 0);
+
+        Plan *plan = getPlan(size);
+        VK_CHECK(plan != nullptr);
+
+        // Update parameters.
+        pParamsBuffer->alpha = alpha;
+        pParamsBuffer->reset = reset || size != lastSize;
+        lastSize = size;
+
+        // Copy samples to staging buffer.
+        memcpy(pStagingBuffer, samples, S2B(size));
+        stagingBuffer->flush(0, S2B(size));
+
+        // Run the transform and wait for it.
+        VK_CALL(vkResetFences, context->device(), 1, vkFence);
+        VK_CHECK(context->submitCommandBuffer(*plan->commandBuffer, vkFence, queueIndex));
+        VK_CALL(vkWaitForFences, context->device(), 1, vkFence, VK_TRUE, -1ull);
+
+        // Copy spectrum and peaks from output buffer.
+        memcpy(spectrum, pOutputBuffer, F2B(size));
+        if (peaks != nullptr) {
+            memcpy(peaks, (const float *) pOutputBuffer + size, F2B(size));
+        }
+
+        return true;
+    }
+
+    Spectrum::~Spectrum() {
+        // Transforms are waited for as they are submitted, the fence is signalled unless one failed.
+        if ((VkFence) vkFence != VK_NULL_HANDLE) {
+            vkWaitForFences(context->device(), 1, vkFence, VK_TRUE, -1ull);
+        }
+    }
+}
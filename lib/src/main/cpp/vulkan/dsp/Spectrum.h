@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ShiftDecimator.h"
+#include "vulkan/Context.h"
+#include "vulkan/Buffer.h"
+#include "pipelines/FFT.h"
+#include "pipelines/FFTPass.h"
+
+#define MIN_FFT_SIZE 16
+#define MAX_FFT_BITS 20
+#define MAX_FFT_SIZE (1 << MAX_FFT_BITS)
+
+namespace Vulkan::DSP {
+    // Per-frame parameters, must match the Params block in fft.comp.
+    struct SpectrumParams {
+        // Weight of the new frame in the exponential average of the power, 1 disables averaging.
+        float alpha;
+        // Restart averaging and peak hold from this frame.
+        uint32_t reset;
+    };
+
+    // Windowed power spectrum in dB with averaging and peak hold, for power of two sizes up to the maximum size.
+    struct Spectrum {
+        static std::unique_ptr<Spectrum> create(Context *, size_t maxSize);
+
+        Spectrum(Context *context, size_t maxSize)
+            : context(context), queueIndex(context->assignQueue()), vkCommandPool(context->device()), maxSize(maxSize), vkFence(context->device()) {}
+        ~Spectrum();
+
+        // Window for transforms of window.size() samples, transforms without one use a rectangular window.
+        bool setWindow(const std::vector<float> &window);
+        // Spectrum and peaks receive size levels each with the center frequency in the middle, peaks may be null.
+        bool process(const float *samples, size_t size, float alpha, bool reset, float *spectrum, float *peaks);
+
+    private:
+        bool initialize();
+
+        // Buffers, pipelines and commands of one transform size, created on first use and kept.
+        struct Plan {
+            std::unique_ptr<Buffer> twiddlesBuffer;
+            std::unique_ptr<Buffer> windowBuffer;
+
+            std::unique_ptr<Pipelines::FFTPass> firstPass;
+            std::unique_ptr<Pipelines::FFTPass> pass;
+            std::unique_ptr<Pipelines::FFT> fft;
+
+            std::unique_ptr<VulkanCommandBuffer> commandBuffer;
+        };
+
+        Plan *getPlan(size_t size);
+        bool createPlan(Plan &plan, size_t size);
+
+        static constexpr size_t groupSize = 64;
+        static constexpr size_t maxBlockSize = 4096;
+
+        Context * const context;
+        // Queue the instance submits to, instances are spread over the queues of the context.
+        const size_t queueIndex;
+        // Command buffers are allocated from a pool of the instance, command pools can't be shared between threads.
+        VulkanCommandPool vkCommandPool;
+
+        const size_t maxSize;
+        // Largest block transformed in shared memory, larger transforms start with radix-4 passes in global memory.
+        size_t blockSize = 0;
+        // Size of the previous frame, averaging and peak hold restart when it changes.
+        size_t lastSize = 0;
+
+        std::unique_ptr<Buffer> paramsBuffer;
+        std::unique_ptr<Buffer> stagingBuffer;
+        std::unique_ptr<Buffer> workBuffer;
+        std::unique_ptr<Buffer> stateBuffer;
+        std::unique_ptr<Buffer> outputBuffer;
+
+        SpectrumParams *pParamsBuffer = nullptr;
+        void *pStagingBuffer = nullptr;
+        void *pOutputBuffer = nullptr;
+
+        std::unique_ptr<Plan> plans[MAX_FFT_BITS + 1];
+
+        VulkanFence vkFence;
+    };
+}
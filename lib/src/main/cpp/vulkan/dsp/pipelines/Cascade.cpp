@@ -0,0 +1,81 @@
+#include "Cascade.h"
+
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/cascade.comp.spv";
+
+    std::unique_ptr<Cascade> Cascade::create(const Context *context, uint32_t workGroupSize, uint32_t tileSize, const uint32_t windows[2], const uint32_t strides[3],
+                                             bool halfInput, unsigned first, unsigned last, const Buffer *paramsBuffer, const Buffer *tapsBuffer,
+                                             const Buffer *inBuffer, const Buffer *historyBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<Cascade>(context, workGroupSize, first, last);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, tileSize, windows, strides, halfInput) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, tapsBuffer, inBuffer, historyBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool Cascade::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 4,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                }
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool Cascade::createComputePipeline(const char *shader, uint32_t tileSize, const uint32_t windows[2], const uint32_t strides[3], bool halfInput) {
+        const VkPushConstantRange pushConstantRange = {
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .offset = 0,
+                .size = sizeof(PushConstants),
+        };
+        VK_CHECK(Pipeline::createComputePipeline(shader, &pushConstantRange, {tileSize, windows[0], windows[1], strides[0], strides[1], strides[2], halfInput}));
+        return true;
+    }
+
+    bool Cascade::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *historyBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, tapsBuffer, inBuffer, historyBuffer, outBuffer}));
+        return true;
+    }
+
+    void Cascade::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        vkCmdPushConstants(commandBuffer, vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+
+namespace Vulkan::DSP::Pipelines {
+    struct Cascade : Pipeline {
+        static std::unique_ptr<Cascade> create(const Context *context, uint32_t workGroupSize, uint32_t tileSize, const uint32_t windows[2], const uint32_t strides[3],
+                                               bool halfInput, unsigned first, unsigned last, const Buffer *paramsBuffer, const Buffer *tapsBuffer,
+                                               const Buffer *inBuffer, const Buffer *historyBuffer, const Buffer *outBuffer);
+
+        Cascade(const Context *context, uint32_t workGroupSize, unsigned first, unsigned last) : Pipeline(context, workGroupSize), pushConstants{first, last} {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, uint32_t tileSize, const uint32_t windows[2], const uint32_t strides[3], bool halfInput);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *historyBuffer, const Buffer *outBuffer);
+
+        struct PushConstants {
+            unsigned first;
+            unsigned last;
+        } pushConstants [[gnu::packed]];
+    };
+}
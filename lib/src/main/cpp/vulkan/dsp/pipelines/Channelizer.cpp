@@ -0,0 +1,68 @@
+#include "Channelizer.h"
+
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/channelizer.comp.spv";
+
+    std::unique_ptr<Channelizer> Channelizer::create(const Context *context, uint32_t workGroupSize,
+                                                     uint32_t branches, uint32_t decimation, uint32_t tapsPerBranch, uint32_t outStride,
+                                                   const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<Channelizer>(context, workGroupSize);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, branches, decimation, tapsPerBranch, outStride) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, tapsBuffer, inBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool Channelizer::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool Channelizer::createComputePipeline(const char *shader, uint32_t branches, uint32_t decimation, uint32_t tapsPerBranch, uint32_t outStride) {
+        VK_CHECK(Pipeline::createComputePipeline(shader, nullptr, {branches, decimation, tapsPerBranch, outStride}));
+        return true;
+    }
+
+    bool Channelizer::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, tapsBuffer, inBuffer, outBuffer}));
+        return true;
+    }
+
+    void Channelizer::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+
+namespace Vulkan::DSP::Pipelines {
+    struct Channelizer : Pipeline {
+        static std::unique_ptr<Channelizer> create(const Context *context, uint32_t workGroupSize,
+                                                   uint32_t branches, uint32_t decimation, uint32_t tapsPerBranch, uint32_t outStride,
+                                                   const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+
+        Channelizer(const Context *context, uint32_t workGroupSize) : Pipeline(context, workGroupSize) {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, uint32_t branches, uint32_t decimation, uint32_t tapsPerBranch, uint32_t outStride);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+    };
+}
@@ -0,0 +1,77 @@
+#include "Copier.h"
+
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/copier.comp.spv";
+
+    std::unique_ptr<Copier> Copier::create(const Context *context, uint32_t workGroupSize, unsigned index, uint32_t channels, const uint32_t strides[2],
+                                           const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *outBuffer, bool shift,
+                                           bool halfSrc, bool halfDst, SampleFormat format) {
+        auto pipeline = std::make_unique<Copier>(context, workGroupSize, index, channels, shift, halfSrc, halfDst, format);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, strides) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, inBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool Copier::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool Copier::createComputePipeline(const char *shader, const uint32_t strides[2]) {
+        const VkPushConstantRange pushConstantRange = {
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .offset = 0,
+                .size = sizeof(PushConstants),
+        };
+        std::vector<uint32_t> constants = {shift, strides[0], strides[1], halfSrc, halfDst};
+        addSampleFormatConstants(constants, format);
+        VK_CHECK(Pipeline::createComputePipeline(shader, &pushConstantRange, constants));
+        return true;
+    }
+
+    bool Copier::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, inBuffer, outBuffer}));
+        return true;
+    }
+
+    void Copier::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        vkCmdPushConstants(commandBuffer, vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
+    }
+
+    void Copier::recordComputeCommands(VkCommandBuffer commandBuffer) {
+        // A single work group per channel walks the whole range, so source and destination may overlap.
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        vkCmdPushConstants(commandBuffer, vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatch(commandBuffer, 1, channels, 1);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+#include "vulkan/dsp/SampleFormat.h"
+
+namespace Vulkan::DSP::Pipelines {
+    struct Copier : Pipeline {
+        static std::unique_ptr<Copier> create(const Context *context, uint32_t workGroupSize, unsigned index, uint32_t channels, const uint32_t strides[2],
+                                              const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *outBuffer, bool shift = false,
+                                              bool halfSrc = false, bool halfDst = false, SampleFormat format = SampleFormat::F32);
+
+        Copier(const Context *context, uint32_t workGroupSize, unsigned index, uint32_t channels, bool shift, bool halfSrc, bool halfDst, SampleFormat format)
+            : Pipeline(context, workGroupSize), channels(channels), shift(shift), halfSrc(halfSrc), halfDst(halfDst), format(format), pushConstants{index} {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
+        void recordComputeCommands(VkCommandBuffer commandBuffer);
+
+        bool setInputBuffer(const Buffer *inBuffer) { return updateDescriptorSet(1, inBuffer); }
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, const uint32_t strides[2]);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+
+        // Rows of work groups of a direct dispatch, one per channel.
+        const uint32_t channels;
+        // Rotate samples by the shifter phase while copying.
+        const bool shift;
+        // Source and destination buffers hold half precision samples.
+        const bool halfSrc;
+        const bool halfDst;
+        // Layout of the source samples, when reading the staging buffer.
+        const SampleFormat format;
+
+        struct PushConstants {
+            unsigned index;
+        } pushConstants [[gnu::packed]];
+    };
+}
@@ -1,19 +1,35 @@
 #include "Decimator.h"
 
+#include <cstring>
 #include <vector>
 
 namespace Vulkan::DSP::Pipelines {
     static constexpr const char *SHADER_FILE = "shaders/decimator.comp.spv";
+    static constexpr const char *TILED_SHADER_FILE = "shaders/tileddecimator.comp.spv";
+    static constexpr const char *SUBGROUP_SHADER_FILE = "shaders/subgroupdecimator.comp.spv";
 
-    std::unique_ptr<Decimator> Decimator::create(const Context *context, uint32_t workGroupSize, unsigned index,
-                                                 const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
-        auto pipeline = std::make_unique<Decimator>(context, workGroupSize, index);
+    std::unique_ptr<Decimator> Decimator::create(const Context *context, uint32_t workGroupSize, unsigned index, const uint32_t strides[2],
+                                                 const bool halfPrecision[2], const std::vector<float> &taps, bool bakeTaps, const Buffer *paramsBuffer,
+                                                 const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<Decimator>(context, workGroupSize, index, taps.size());
         const bool success = pipeline->createDescriptorSet() &&
-                             pipeline->createComputePipeline(SHADER_FILE) &&
+                             pipeline->createComputePipeline(pipeline->selectShader(), strides, halfPrecision, taps, bakeTaps) &&
                              pipeline->updateDescriptorSets(paramsBuffer, tapsBuffer, inBuffer, outBuffer);
         return success ? std::move(pipeline) : nullptr;
     }
 
+    const char *Decimator::selectShader() const {
+        if (window * 2 * sizeof(float) > context->maxSharedMemorySize()) {
+            return SHADER_FILE;
+        }
+        // Shuffles from past the end of a partial subgroup are undefined, work groups must hold whole subgroups.
+        const uint32_t subgroupSize = context->subgroupSize();
+        if (context->supportsSubgroupShuffleRelative() && subgroupSize != 0 && workGroupSize % subgroupSize == 0) {
+            return SUBGROUP_SHADER_FILE;
+        }
+        return TILED_SHADER_FILE;
+    }
+
     bool Decimator::createDescriptorSet() {
         std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
                 {
@@ -49,76 +65,43 @@ namespace Vulkan::DSP::Pipelines {
         return true;
     }
 
-    bool Decimator::createComputePipeline(const char *shader) {
+    bool Decimator::createComputePipeline(const char *shader, const uint32_t strides[2], const bool halfPrecision[2], const std::vector<float> &taps, bool bakeTaps) {
         const VkPushConstantRange pushConstantRange = {
                 .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
                 .offset = 0,
                 .size = sizeof(PushConstants),
         };
-        VK_CHECK(Pipeline::createComputePipeline(shader, &pushConstantRange));
+        std::vector<uint32_t> constants = {window, strides[0], strides[1], halfPrecision[0], halfPrecision[1]};
+        addTapConstants(constants, taps, bakeTaps);
+        VK_CHECK(Pipeline::createComputePipeline(shader, &pushConstantRange, constants));
         return true;
     }
 
-    bool Decimator::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
-        std::vector<VkWriteDescriptorSet> descriptorSet = {
-                {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .pNext = nullptr,
-                        .dstSet = vkDescriptorSet,
-                        .dstBinding = 0,
-                        .dstArrayElement = 0,
-                        .descriptorCount = 1,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        .pImageInfo = nullptr,
-                        .pBufferInfo = &paramsBuffer->descriptor(),
-                        .pTexelBufferView = nullptr,
-                },
-                {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .pNext = nullptr,
-                        .dstSet = vkDescriptorSet,
-                        .dstBinding = 1,
-                        .dstArrayElement = 0,
-                        .descriptorCount = 1,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        .pImageInfo = nullptr,
-                        .pBufferInfo = &tapsBuffer->descriptor(),
-                        .pTexelBufferView = nullptr,
-                },
-                {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .pNext = nullptr,
-                        .dstSet = vkDescriptorSet,
-                        .dstBinding = 2,
-                        .dstArrayElement = 0,
-                        .descriptorCount = 1,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        .pImageInfo = nullptr,
-                        .pBufferInfo = &inBuffer->descriptor(),
-                        .pTexelBufferView = nullptr,
-                },
-                {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .pNext = nullptr,
-                        .dstSet = vkDescriptorSet,
-                        .dstBinding = 3,
-                        .dstArrayElement = 0,
-                        .descriptorCount = 1,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        .pImageInfo = nullptr,
-                        .pBufferInfo = &outBuffer->descriptor(),
-                        .pTexelBufferView = nullptr,
-                }
-        };
-        vkUpdateDescriptorSets(context->device(), (uint32_t) descriptorSet.size(), descriptorSet.data(), 0, nullptr);
+    void Decimator::addTapConstants(std::vector<uint32_t> &constants, const std::vector<float> &taps, bool bakeTaps) {
+        // Longer filters keep reading the taps buffer.
+        bakeTaps = bakeTaps && taps.size() <= MAX_BAKED_TAPS;
+
+        constants.push_back((uint32_t) taps.size());
+        constants.push_back(bakeTaps);
 
+        if (bakeTaps) {
+            for (float tap : taps) {
+                uint32_t bits;
+                memcpy(&bits, &tap, sizeof(bits));
+                constants.push_back(bits);
+            }
+        }
+    }
+
+    bool Decimator::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, tapsBuffer, inBuffer, outBuffer}));
         return true;
     }
 
-    void Decimator::recordComputeCommands(VkCommandBuffer commandBuffer, size_t numOutputSamples) {
+    void Decimator::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
         vkCmdPushConstants(commandBuffer, vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipelineLayout, 0, 1, &vkDescriptorSet, 0, nullptr);
-        vkCmdDispatch(commandBuffer, numOutputSamples / workGroupSize, 1, 1);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
     }
 }
@@ -3,20 +3,34 @@
 #include "vulkan/Buffer.h"
 #include "vulkan/Pipeline.h"
 
+// Taps baked into the decimator shaders as specialization constants, must match the shaders.
+#define MAX_BAKED_TAPS 48
+
 namespace Vulkan::DSP::Pipelines {
     struct Decimator : Pipeline {
-        static std::unique_ptr<Decimator> create(const Context *context, uint32_t workGroupSize, unsigned index,
-                                                 const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+        static std::unique_ptr<Decimator> create(const Context *context, uint32_t workGroupSize, unsigned index, const uint32_t strides[2],
+                                                 const bool halfPrecision[2], const std::vector<float> &taps, bool bakeTaps, const Buffer *paramsBuffer,
+                                                 const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+
+        Decimator(const Context *context, uint32_t workGroupSize, unsigned index, uint32_t tapCount)
+            : Pipeline(context, workGroupSize), window(2 * workGroupSize - 2 + tapCount), pushConstants{index} {}
 
-        Decimator(const Context *context, uint32_t workGroupSize, unsigned index) : Pipeline(context, workGroupSize), pushConstants{index} {}
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
 
-        void recordComputeCommands(VkCommandBuffer commandBuffer, size_t numOutputSamples);
+        // Appends the tap count and, when baking and they fit, the taps themselves to the specialization constants.
+        static void addTapConstants(std::vector<uint32_t> &constants, const std::vector<float> &taps, bool bakeTaps);
 
     protected:
+        // Variant that reads the input once per work group, with subgroup shuffles if the device has them.
+        const char *selectShader() const;
+
         bool createDescriptorSet();
-        bool createComputePipeline(const char *shader);
+        bool createComputePipeline(const char *shader, const uint32_t strides[2], const bool halfPrecision[2], const std::vector<float> &taps, bool bakeTaps);
         bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
 
+        // Input samples loaded into shared memory by a work group of the tiled variants.
+        const uint32_t window;
+
         struct PushConstants {
             unsigned index;
         } pushConstants [[gnu::packed]];
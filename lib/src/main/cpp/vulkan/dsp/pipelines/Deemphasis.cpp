@@ -0,0 +1,77 @@
+#include "Deemphasis.h"
+
+#include <cstring>
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/deemphasis.comp.spv";
+
+    std::unique_ptr<Deemphasis> Deemphasis::create(const Context *context, uint32_t workGroupSize, unsigned index, const uint32_t strides[2], float alpha,
+                                                   const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *stateBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<Deemphasis>(context, workGroupSize, index);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, strides, alpha) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, inBuffer, stateBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool Deemphasis::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool Deemphasis::createComputePipeline(const char *shader, const uint32_t strides[2], float alpha) {
+        const VkPushConstantRange pushConstantRange = {
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .offset = 0,
+                .size = sizeof(PushConstants),
+        };
+        uint32_t alphaBits;
+        memcpy(&alphaBits, &alpha, sizeof(alphaBits));
+        const std::vector<uint32_t> constants = {strides[0], strides[1], alphaBits};
+        VK_CHECK(Pipeline::createComputePipeline(shader, &pushConstantRange, constants));
+        return true;
+    }
+
+    bool Deemphasis::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *stateBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, inBuffer, stateBuffer, outBuffer}));
+        return true;
+    }
+
+    void Deemphasis::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        vkCmdPushConstants(commandBuffer, vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
+    }
+}
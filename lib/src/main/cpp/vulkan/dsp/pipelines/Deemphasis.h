@@ -0,0 +1,25 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+
+namespace Vulkan::DSP::Pipelines {
+    // Single pole de-emphasis filter of real samples, writing complex samples. Runs one work group per channel.
+    struct Deemphasis : Pipeline {
+        static std::unique_ptr<Deemphasis> create(const Context *context, uint32_t workGroupSize, unsigned index, const uint32_t strides[2], float alpha,
+                                                  const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *stateBuffer, const Buffer *outBuffer);
+
+        Deemphasis(const Context *context, uint32_t workGroupSize, unsigned index) : Pipeline(context, workGroupSize), pushConstants{index} {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, const uint32_t strides[2], float alpha);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *stateBuffer, const Buffer *outBuffer);
+
+        struct PushConstants {
+            unsigned index;
+        } pushConstants [[gnu::packed]];
+    };
+}
@@ -0,0 +1,83 @@
+#include "FFT.h"
+
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/fft.comp.spv";
+
+    std::unique_ptr<FFT> FFT::create(const Context *context, uint32_t workGroupSize, uint32_t size, uint32_t blockSize, bool window,
+                                     const Buffer *paramsBuffer, const Buffer *twiddlesBuffer, const Buffer *windowBuffer,
+                                     const Buffer *inBuffer, const Buffer *stateBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<FFT>(context, workGroupSize, size / blockSize);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, size, blockSize, window) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, twiddlesBuffer, windowBuffer, inBuffer, stateBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool FFT::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 4,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 5,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool FFT::createComputePipeline(const char *shader, uint32_t size, uint32_t blockSize, bool window) {
+        VK_CHECK(Pipeline::createComputePipeline(shader, nullptr, {size, blockSize, window}));
+        return true;
+    }
+
+    bool FFT::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *twiddlesBuffer, const Buffer *windowBuffer,
+                                   const Buffer *inBuffer, const Buffer *stateBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, twiddlesBuffer, windowBuffer, inBuffer, stateBuffer, outBuffer}));
+        return true;
+    }
+
+    void FFT::recordComputeCommands(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatch(commandBuffer, blockCount, 1, 1);
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+
+namespace Vulkan::DSP::Pipelines {
+    // Transforms blocks of blockSize samples in shared memory, one work group per block, and turns them into the power spectrum.
+    struct FFT : Pipeline {
+        static std::unique_ptr<FFT> create(const Context *context, uint32_t workGroupSize, uint32_t size, uint32_t blockSize, bool window,
+                                           const Buffer *paramsBuffer, const Buffer *twiddlesBuffer, const Buffer *windowBuffer,
+                                           const Buffer *inBuffer, const Buffer *stateBuffer, const Buffer *outBuffer);
+
+        FFT(const Context *context, uint32_t workGroupSize, uint32_t blockCount) : Pipeline(context, workGroupSize), blockCount(blockCount) {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer);
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, uint32_t size, uint32_t blockSize, bool window);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *twiddlesBuffer, const Buffer *windowBuffer,
+                                  const Buffer *inBuffer, const Buffer *stateBuffer, const Buffer *outBuffer);
+
+        const uint32_t blockCount;
+    };
+}
@@ -0,0 +1,75 @@
+#include "FFTPass.h"
+
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/fftpass.comp.spv";
+
+    std::unique_ptr<FFTPass> FFTPass::create(const Context *context, uint32_t workGroupSize, uint32_t size, bool window,
+                                             const Buffer *twiddlesBuffer, const Buffer *windowBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<FFTPass>(context, workGroupSize, size);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, size, window) &&
+                             pipeline->updateDescriptorSets(twiddlesBuffer, windowBuffer, inBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool FFTPass::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool FFTPass::createComputePipeline(const char *shader, uint32_t size, bool window) {
+        const VkPushConstantRange pushConstantRange = {
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .offset = 0,
+                .size = sizeof(PushConstants),
+        };
+        VK_CHECK(Pipeline::createComputePipeline(shader, &pushConstantRange, {size, window}));
+        return true;
+    }
+
+    bool FFTPass::updateDescriptorSets(const Buffer *twiddlesBuffer, const Buffer *windowBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({twiddlesBuffer, windowBuffer, inBuffer, outBuffer}));
+        return true;
+    }
+
+    void FFTPass::recordComputeCommands(VkCommandBuffer commandBuffer, uint32_t span) {
+        // One invocation per radix-4 butterfly.
+        pushConstants.span = span;
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        vkCmdPushConstants(commandBuffer, vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatch(commandBuffer, (size / 4 + workGroupSize - 1) / workGroupSize, 1, 1);
+    }
+}
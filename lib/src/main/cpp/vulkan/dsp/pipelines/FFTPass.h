@@ -0,0 +1,27 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+
+namespace Vulkan::DSP::Pipelines {
+    // One radix-4 decimation in frequency pass over the whole transform, splitting blocks of span samples into four.
+    struct FFTPass : Pipeline {
+        static std::unique_ptr<FFTPass> create(const Context *context, uint32_t workGroupSize, uint32_t size, bool window,
+                                               const Buffer *twiddlesBuffer, const Buffer *windowBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+
+        FFTPass(const Context *context, uint32_t workGroupSize, uint32_t size) : Pipeline(context, workGroupSize), size(size) {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, uint32_t span);
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, uint32_t size, bool window);
+        bool updateDescriptorSets(const Buffer *twiddlesBuffer, const Buffer *windowBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+
+        const uint32_t size;
+
+        struct PushConstants {
+            uint32_t span;
+        } pushConstants [[gnu::packed]];
+    };
+}
@@ -0,0 +1,86 @@
+#include "FIR.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/fir.comp.spv";
+
+    std::unique_ptr<FIR> FIR::create(const Context *context, uint32_t workGroupSize, unsigned index, const uint32_t strides[2], uint32_t decimation,
+                                     const std::vector<float> &taps, bool complex, const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer,
+                                     const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<FIR>(context, workGroupSize, index);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, strides, decimation, taps, complex) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, tapsBuffer, inBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool FIR::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool FIR::createComputePipeline(const char *shader, const uint32_t strides[2], uint32_t decimation, const std::vector<float> &taps, bool complex) {
+        const VkPushConstantRange pushConstantRange = {
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .offset = 0,
+                .size = sizeof(PushConstants),
+        };
+        // Designed filters are symmetric up to rounding, the first half of the taps is used for both halves.
+        float largest = 0.0f;
+        for (float tap: taps) {
+            largest = std::max(largest, std::abs(tap));
+        }
+        bool symmetric = true;
+        for (size_t i = 0; i < taps.size() / 2; i++) {
+            symmetric = symmetric && std::abs(taps[i] - taps[taps.size() - 1 - i]) <= 1e-6f * largest;
+        }
+        const std::vector<uint32_t> constants = {strides[0], strides[1], decimation, (uint32_t) taps.size(), complex, symmetric};
+        VK_CHECK(Pipeline::createComputePipeline(shader, &pushConstantRange, constants));
+        return true;
+    }
+
+    bool FIR::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, tapsBuffer, inBuffer, outBuffer}));
+        return true;
+    }
+
+    void FIR::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        vkCmdPushConstants(commandBuffer, vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+
+namespace Vulkan::DSP::Pipelines {
+    // Decimating FIR filter of real or complex samples with any taps, reading and writing rings like the decimator stages.
+    // Symmetric taps are folded, halving the multiplications.
+    struct FIR : Pipeline {
+        static std::unique_ptr<FIR> create(const Context *context, uint32_t workGroupSize, unsigned index, const uint32_t strides[2], uint32_t decimation,
+                                           const std::vector<float> &taps, bool complex, const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer,
+                                           const Buffer *outBuffer);
+
+        FIR(const Context *context, uint32_t workGroupSize, unsigned index) : Pipeline(context, workGroupSize), pushConstants{index} {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, const uint32_t strides[2], uint32_t decimation, const std::vector<float> &taps, bool complex);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+
+        struct PushConstants {
+            unsigned index;
+        } pushConstants [[gnu::packed]];
+    };
+}
@@ -0,0 +1,68 @@
+#include "Polyphase.h"
+
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/polyphase.comp.spv";
+
+    std::unique_ptr<Polyphase> Polyphase::create(const Context *context, uint32_t workGroupSize,
+                                                 uint32_t interpolation, uint32_t decimation, uint32_t tapsPerPhase, const uint32_t strides[2],
+                                                 const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<Polyphase>(context, workGroupSize);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, interpolation, decimation, tapsPerPhase, strides) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, tapsBuffer, inBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool Polyphase::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool Polyphase::createComputePipeline(const char *shader, uint32_t interpolation, uint32_t decimation, uint32_t tapsPerPhase, const uint32_t strides[2]) {
+        VK_CHECK(Pipeline::createComputePipeline(shader, nullptr, {interpolation, decimation, tapsPerPhase, strides[0], strides[1]}));
+        return true;
+    }
+
+    bool Polyphase::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, tapsBuffer, inBuffer, outBuffer}));
+        return true;
+    }
+
+    void Polyphase::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
+    }
+}
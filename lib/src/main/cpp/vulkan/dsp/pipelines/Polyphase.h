@@ -0,0 +1,21 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+
+namespace Vulkan::DSP::Pipelines {
+    struct Polyphase : Pipeline {
+        static std::unique_ptr<Polyphase> create(const Context *context, uint32_t workGroupSize,
+                                                 uint32_t interpolation, uint32_t decimation, uint32_t tapsPerPhase, const uint32_t strides[2],
+                                                 const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+
+        Polyphase(const Context *context, uint32_t workGroupSize) : Pipeline(context, workGroupSize) {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, uint32_t interpolation, uint32_t decimation, uint32_t tapsPerPhase, const uint32_t strides[2]);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer, const Buffer *outBuffer);
+    };
+}
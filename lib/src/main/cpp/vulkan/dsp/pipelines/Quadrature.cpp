@@ -0,0 +1,77 @@
+#include "Quadrature.h"
+
+#include <cstring>
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/quadrature.comp.spv";
+
+    std::unique_ptr<Quadrature> Quadrature::create(const Context *context, uint32_t workGroupSize, unsigned index, const uint32_t strides[2], float gain,
+                                                   const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *historyBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<Quadrature>(context, workGroupSize, index);
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, strides, gain) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, inBuffer, historyBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool Quadrature::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool Quadrature::createComputePipeline(const char *shader, const uint32_t strides[2], float gain) {
+        const VkPushConstantRange pushConstantRange = {
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .offset = 0,
+                .size = sizeof(PushConstants),
+        };
+        uint32_t gainBits;
+        memcpy(&gainBits, &gain, sizeof(gainBits));
+        const std::vector<uint32_t> constants = {strides[0], strides[1], gainBits};
+        VK_CHECK(Pipeline::createComputePipeline(shader, &pushConstantRange, constants));
+        return true;
+    }
+
+    bool Quadrature::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *historyBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, inBuffer, historyBuffer, outBuffer}));
+        return true;
+    }
+
+    void Quadrature::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        vkCmdPushConstants(commandBuffer, vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+
+namespace Vulkan::DSP::Pipelines {
+    // Quadrature FM demodulator, writes the phase difference of consecutive complex samples scaled by gain as real samples.
+    struct Quadrature : Pipeline {
+        static std::unique_ptr<Quadrature> create(const Context *context, uint32_t workGroupSize, unsigned index, const uint32_t strides[2], float gain,
+                                                  const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *historyBuffer, const Buffer *outBuffer);
+
+        Quadrature(const Context *context, uint32_t workGroupSize, unsigned index) : Pipeline(context, workGroupSize), pushConstants{index} {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, const uint32_t strides[2], float gain);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *inBuffer, const Buffer *historyBuffer, const Buffer *outBuffer);
+
+        struct PushConstants {
+            unsigned index;
+        } pushConstants [[gnu::packed]];
+    };
+}
@@ -0,0 +1,81 @@
+#include "ShiftDecimator.h"
+
+#include <vector>
+
+namespace Vulkan::DSP::Pipelines {
+    static constexpr const char *SHADER_FILE = "shaders/shiftdecimator.comp.spv";
+
+    std::unique_ptr<ShiftDecimator> ShiftDecimator::create(const Context *context, uint32_t workGroupSize, const uint32_t strides[2],
+                                                           const bool halfPrecision[2], const std::vector<float> &taps, bool bakeTaps, SampleFormat format,
+                                                           const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer,
+                                                           const Buffer *stagingBuffer, const Buffer *outBuffer) {
+        auto pipeline = std::make_unique<ShiftDecimator>(context, workGroupSize, taps.size());
+        const bool success = pipeline->createDescriptorSet() &&
+                             pipeline->createComputePipeline(SHADER_FILE, strides, halfPrecision, taps, bakeTaps, format) &&
+                             pipeline->updateDescriptorSets(paramsBuffer, tapsBuffer, inBuffer, stagingBuffer, outBuffer);
+        return success ? std::move(pipeline) : nullptr;
+    }
+
+    bool ShiftDecimator::createDescriptorSet() {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBinding = {
+                {
+                        .binding = 0,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 1,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 2,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 3,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+                {
+                        .binding = 4,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = 1,
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .pImmutableSamplers = nullptr,
+                },
+        };
+        VK_CHECK(Pipeline::createDescriptorSet(layoutBinding));
+        return true;
+    }
+
+    bool ShiftDecimator::createComputePipeline(const char *shader, const uint32_t strides[2], const bool halfPrecision[2], const std::vector<float> &taps, bool bakeTaps,
+                                               SampleFormat format) {
+        std::vector<uint32_t> constants = {window, strides[0], strides[1], halfPrecision[0], halfPrecision[1]};
+        addSampleFormatConstants(constants, format);
+        Decimator::addTapConstants(constants, taps, bakeTaps);
+        VK_CHECK(Pipeline::createComputePipeline(shader, nullptr, constants));
+        return true;
+    }
+
+    bool ShiftDecimator::updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer,
+                                              const Buffer *stagingBuffer, const Buffer *outBuffer) {
+        VK_CHECK(Pipeline::updateDescriptorSets({paramsBuffer, tapsBuffer, inBuffer, stagingBuffer, outBuffer}));
+        return true;
+    }
+
+    void ShiftDecimator::recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline);
+        bindDescriptorSet(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer->handle(), dispatchOffset);
+    }
+}
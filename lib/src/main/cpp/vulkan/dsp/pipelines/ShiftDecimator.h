@@ -0,0 +1,33 @@
+#pragma once
+
+#include "vulkan/Buffer.h"
+#include "vulkan/Pipeline.h"
+#include "Decimator.h"
+#include "vulkan/dsp/SampleFormat.h"
+
+namespace Vulkan::DSP::Pipelines {
+    // First decimator stage, converts and shifts new samples from the staging buffer while loading them.
+    struct ShiftDecimator : Pipeline {
+        static std::unique_ptr<ShiftDecimator> create(const Context *context, uint32_t workGroupSize, const uint32_t strides[2],
+                                                      const bool halfPrecision[2], const std::vector<float> &taps, bool bakeTaps, SampleFormat format,
+                                                      const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer,
+                                                      const Buffer *stagingBuffer, const Buffer *outBuffer);
+
+        ShiftDecimator(const Context *context, uint32_t workGroupSize, uint32_t tapCount)
+            : Pipeline(context, workGroupSize), window(2 * workGroupSize - 2 + tapCount) {}
+
+        void recordComputeCommands(VkCommandBuffer commandBuffer, const Buffer *dispatchBuffer, VkDeviceSize dispatchOffset);
+
+        bool setStagingBuffer(const Buffer *stagingBuffer) { return updateDescriptorSet(3, stagingBuffer); }
+
+    protected:
+        bool createDescriptorSet();
+        bool createComputePipeline(const char *shader, const uint32_t strides[2], const bool halfPrecision[2], const std::vector<float> &taps, bool bakeTaps,
+                                   SampleFormat format);
+        bool updateDescriptorSets(const Buffer *paramsBuffer, const Buffer *tapsBuffer, const Buffer *inBuffer,
+                                  const Buffer *stagingBuffer, const Buffer *outBuffer);
+
+        // Input samples loaded into shared memory by a work group.
+        const uint32_t window;
+    };
+}
@@ -12,9 +12,20 @@ import kotlin.math.log2
 import kotlin.math.min
 import kotlin.math.round
 
-class Resampler(private val inputSampleRate: Int, val outputSampleRate: Int, gpuAPI: GPUAPI = GPUAPI.None, numTaps: Int = 9) {
+class Resampler(
+    private val inputSampleRate: Int,
+    val outputSampleRate: Int,
+    gpuAPI: GPUAPI = GPUAPI.None,
+    numTaps: Int = 9,
+    // Demodulates the resampled signal on the GPU when the Vulkan decimator runs the whole resampler.
+    demodulator: VulkanShiftDecimator.Demodulator? = null,
+) {
     enum class Type { CPU, GLES, VK }
 
+    // Outputs are the demodulated signal instead of the resampled one.
+    var demodulates = false
+        private set
+
     private var glesShiftDecimator: GLESShiftDecimator? = null
     private var vkShiftDecimator: VulkanShiftDecimator? = null
 
@@ -31,13 +42,6 @@ class Resampler(private val inputSampleRate: Int, val outputSampleRate: Int, gpu
         var interpolatorSampleRate = inputSampleRate.toDouble()
 
         if (inputSampleRate > outputSampleRate && decimatorPower > 0) {
-            if (gpuAPI == GPUAPI.GLES && GLESShiftDecimator.isAvailable(decimatorRatio)) {
-                glesShiftDecimator = GLESShiftDecimator(inputSampleRate, decimatorRatio)
-            } else if (gpuAPI == GPUAPI.Vulkan && VulkanShiftDecimator.isAvailable(decimatorRatio)) {
-                vkShiftDecimator = VulkanShiftDecimator(inputSampleRate, decimatorRatio)
-            } else {
-                decimator = Decimator(decimatorRatio)
-            }
             interpolatorSampleRate /= decimatorRatio
         }
 
@@ -48,16 +52,40 @@ class Resampler(private val inputSampleRate: Int, val outputSampleRate: Int, gpu
         val interpolation = outputSampleRate / gcd
         val decimation = inSampleRate / gcd
 
+        var polyphaseTaps = FloatArray(0)
+
         if (interpolation != decimation) {
             val sampleRate = inSampleRate * interpolation
             val cutoff = min(inputSampleRate, outputSampleRate) / 2.0f
-            val taps = Taps.lowPass(sampleRate.toFloat(), cutoff, interpolation * numTaps)
+            polyphaseTaps = Taps.lowPass(sampleRate.toFloat(), cutoff, interpolation * numTaps)
+
+            for (i in polyphaseTaps.indices) {
+                polyphaseTaps[i] = polyphaseTaps[i] * interpolation
+            }
+        }
 
-            for (i in taps.indices) {
-                taps[i] = taps[i] * interpolation
+        if (inputSampleRate > outputSampleRate && decimatorPower > 0) {
+            if (gpuAPI == GPUAPI.GLES && GLESShiftDecimator.isAvailable(decimatorRatio)) {
+                glesShiftDecimator = GLESShiftDecimator(inputSampleRate, decimatorRatio)
+            } else if (gpuAPI == GPUAPI.Vulkan && VulkanShiftDecimator.isAvailable(decimatorRatio)) {
+                if (interpolation <= VulkanShiftDecimator.MAX_INTERPOLATION) {
+                    // Vulkan runs the polyphase resampler after the decimator too.
+                    vkShiftDecimator = VulkanShiftDecimator(
+                        inputSampleRate, decimatorRatio,
+                        interpolation = interpolation, decimation = decimation, resamplerTaps = polyphaseTaps, demodulator = demodulator
+                    )
+                    polyphaseTaps = FloatArray(0)
+                    demodulates = demodulator != null
+                } else {
+                    vkShiftDecimator = VulkanShiftDecimator(inputSampleRate, decimatorRatio)
+                }
+            } else {
+                decimator = Decimator(decimatorRatio)
             }
+        }
 
-            polyphase = Polyphase(interpolation, decimation, taps)
+        if (polyphaseTaps.isNotEmpty()) {
+            polyphase = Polyphase(interpolation, decimation, polyphaseTaps)
         }
 
         val actualOutputSampleRate = 1.0 * inSampleRate * interpolation / decimation
@@ -2,19 +2,29 @@ package com.hypermagik.spectrum.lib.gpu
 
 import android.content.Context
 import android.content.res.AssetManager
+import java.io.File
 
 class Vulkan {
     companion object {
+        private const val PIPELINE_CACHE_FILE = "vulkan_pipeline_cache.bin"
+
         private var hasContext = false
 
         fun init(context: Context) {
-            hasContext = createContext(VK_DEBUG, context.assets)
+            val pipelineCachePath = File(context.cacheDir, PIPELINE_CACHE_FILE).absolutePath
+            hasContext = createContext(VK_DEBUG, context.assets, pipelineCachePath)
         }
 
         fun isAvailable(): Boolean {
             return hasContext
         }
 
-        private external fun createContext(debug: Boolean, assetManager: AssetManager): Boolean
+        // Decimators order their stages with timeline semaphores, the spectrum and the channelizer work without them.
+        fun supportsDecimators(): Boolean {
+            return hasContext && supportsTimelineSemaphores()
+        }
+
+        private external fun createContext(debug: Boolean, assetManager: AssetManager, pipelineCachePath: String): Boolean
+        private external fun supportsTimelineSemaphores(): Boolean
     }
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+package com.hypermagik.spectrum.lib.gpu
+
+import android.util.Log
+import com.hypermagik.spectrum.lib.data.Complex32
+import com.hypermagik.spectrum.lib.data.Complex32Array
+import com.hypermagik.spectrum.lib.dsp.Taps
+import com.hypermagik.spectrum.lib.utils.fromArray
+import com.hypermagik.spectrum.lib.utils.toArray
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+// Splits the input into channels of sampleRate / channels each, channel i is centered at i * sampleRate / channels
+// and channels past the middle are negative frequencies. Each channel is decimated by decimation, which can be
+// smaller than the number of channels for overlapping, oversampled channels.
+class VulkanChannelizer(
+    val channels: Int,
+    val decimation: Int = channels,
+    tapsPerChannel: Int = 16,
+    depth: Int = 2,
+    taps: FloatArray = Taps.lowPass(channels.toFloat(), 0.5f, channels * tapsPerChannel - 1),
+) {
+    companion object {
+        const val MIN_DEPTH = 2
+        const val MAX_DEPTH = 8
+        const val MAX_CHANNELS = 4096
+        const val MAX_OVERSAMPLING = 4
+
+        external fun create(taps: FloatArray, branches: Int, decimation: Int, depth: Int): Long
+        external fun process(instance: Long, samples: ByteBuffer, sampleCount: Int, output: ByteBuffer): Int
+        external fun delete(instance: Long)
+    }
+
+    private var instance: Long = 0
+
+    private val maxOutputLength = Complex32.MAX_ARRAY_SIZE / decimation + 1
+
+    private var inputArray = FloatArray(Complex32.MAX_ARRAY_SIZE * 2)
+    private var inputBuffer = ByteBuffer.allocateDirect(inputArray.size * Float.SIZE_BYTES).order(ByteOrder.nativeOrder())
+    private var outputArray = FloatArray(maxOutputLength * channels * 2)
+    private var outputBuffer = ByteBuffer.allocateDirect(outputArray.size * Float.SIZE_BYTES).order(ByteOrder.nativeOrder())
+
+    init {
+        if (channels and (channels - 1) != 0 || channels < 2 || channels > MAX_CHANNELS) {
+            throw IllegalArgumentException("Channels must be a power of 2 between 2 and $MAX_CHANNELS")
+        }
+        if (decimation <= 0 || decimation > channels || decimation * MAX_OVERSAMPLING < channels) {
+            throw IllegalArgumentException("Decimation must be between channels / $MAX_OVERSAMPLING and channels")
+        }
+        if (depth < MIN_DEPTH || depth > MAX_DEPTH) {
+            throw IllegalArgumentException("Depth must be between $MIN_DEPTH and $MAX_DEPTH")
+        }
+
+        instance = create(taps, channels, decimation, depth)
+        check(instance != 0L)
+
+        Log.d("VK", "Vulkan channelizer, channels: $channels, decimation: $decimation, taps: ${taps.size}, depth: $depth")
+    }
+
+    // Returns the number of samples written to each output, there must be one output per channel.
+    fun channelize(input: Complex32Array, outputs: Array<Complex32Array>, length: Int): Int {
+        input.toArray(inputArray, 0, length)
+        inputBuffer.asFloatBuffer().put(inputArray, 0, length * 2)
+
+        val outputLength = process(instance, inputBuffer, length, outputBuffer)
+
+        outputBuffer.asFloatBuffer().get(outputArray, 0, outputLength * 2 * channels)
+        for (i in 0 until channels) {
+            outputs[i].fromArray(outputArray, outputLength * i, outputLength)
+        }
+
+        return outputLength
+    }
+
+    fun close() {
+        delete(instance)
+        instance = 0
+    }
+}
@@ -0,0 +1,29 @@
+package com.hypermagik.spectrum.lib.gpu
+
+import android.os.ParcelFileDescriptor
+import android.util.Log
+
+// Recording mapped into memory for playback through a VulkanShiftDecimator with the same sample format,
+// samples after the header are read by the GPU in place where possible. The file descriptor can be closed afterwards.
+class VulkanIQFile(fd: ParcelFileDescriptor, headerSize: Long, val sampleFormat: VulkanShiftDecimator.SampleFormat) {
+    companion object {
+        external fun create(fd: Int, headerSize: Long, sampleFormat: Int): Long
+        external fun delete(instance: Long)
+    }
+
+    internal var instance: Long = 0
+        private set
+
+    init {
+        instance = create(fd.fd, headerSize, sampleFormat.ordinal)
+        check(instance != 0L)
+
+        Log.d("VK", "Vulkan IQ file, header size: $headerSize, sample format: $sampleFormat")
+    }
+
+    // Waits for blocks in flight, which may read the recording.
+    fun close() {
+        delete(instance)
+        instance = 0
+    }
+}
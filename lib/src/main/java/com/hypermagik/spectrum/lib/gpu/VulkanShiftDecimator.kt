@@ -3,6 +3,7 @@ package com.hypermagik.spectrum.lib.gpu
 import android.util.Log
 import com.hypermagik.spectrum.lib.data.Complex32
 import com.hypermagik.spectrum.lib.data.Complex32Array
+import com.hypermagik.spectrum.lib.data.SampleType
 import com.hypermagik.spectrum.lib.dsp.Taps
 import com.hypermagik.spectrum.lib.dsp.Utils.Companion.toRadians
 import com.hypermagik.spectrum.lib.utils.fromArray
@@ -11,17 +12,121 @@ import java.nio.ByteBuffer
 import java.nio.ByteOrder
 import kotlin.math.PI
 import kotlin.math.log2
+import kotlin.math.max
 import kotlin.math.min
 import kotlin.math.pow
 
-class VulkanShiftDecimator(private val sampleRate: Int, private val ratio: Int, forceSingleQueue: Boolean = false) {
+class VulkanShiftDecimator(
+    private val sampleRate: Int,
+    private val ratio: Int,
+    forceSingleQueue: Boolean = false,
+    depth: Int = 2,
+    interpolation: Int = 1,
+    decimation: Int = 1,
+    resamplerTaps: FloatArray = FloatArray(0),
+    private val channels: Int = 1,
+    // Bakes the decimator taps into the shaders instead of reading them from a buffer.
+    bakeTaps: Boolean = false,
+    // Keeps samples between decimator stages in half precision, halving their memory traffic, filters still accumulate in single precision.
+    halfPrecision: Boolean = false,
+    // Layout of the raw samples passed to decimate, converted to floats on the GPU.
+    private val sampleFormat: SampleFormat = SampleFormat.F32,
+    // Largest block processed in one pass, buffers are sized for it and larger blocks are split into chunks.
+    maxBlockSize: Int = MAX_BLOCK_SIZE,
+    // Complex FIR filter after the resampler, such as a matched filter, decimating by filterDecimation. None without taps.
+    filterTaps: FloatArray = FloatArray(0),
+    filterDecimation: Int = 1,
+    // Demodulates the output on the GPU, which then holds real samples with a zero imaginary part.
+    demodulator: Demodulator? = null,
+) {
+    // Must match SampleFormat.h, bytes of a complex sample in each format.
+    enum class SampleFormat(val sampleSize: Int) {
+        F32(2 * Float.SIZE_BYTES),
+        U8(2 * Byte.SIZE_BYTES),
+        S8(2 * Byte.SIZE_BYTES),
+        S12P(2 * Short.SIZE_BYTES),
+        S16(2 * Short.SIZE_BYTES);
+
+        companion object {
+            fun of(type: SampleType): SampleFormat {
+                return when (type) {
+                    SampleType.S8 -> S8
+                    SampleType.U8 -> U8
+                    SampleType.S12P -> S12P
+                    SampleType.F32 -> F32
+                    else -> throw IllegalArgumentException("No sample format for sample type: $type")
+                }
+            }
+        }
+    }
+
+    // Wideband FM demodulator run after the decimator, the resampler and the filter, as the CPU Quadrature demodulator followed by
+    // a decimating FIR for each of the taps and Deemphasis with time constant tau in seconds, none if 0.
+    class Demodulator(
+        val deviation: Int,
+        val taps: Array<FloatArray> = arrayOf(),
+        val decimations: IntArray = IntArray(0),
+        val tau: Float = 0.0f,
+    )
+
+    // Block returned by poll or await. Times are System.nanoTime() values, the block took completionTime - submitTime
+    // from submission until it was seen complete, of which the GPU spent gpuTime nanoseconds running it.
+    class Completion(values: LongArray) {
+        val sequence = values[0]
+        val slot = values[1].toInt()
+        val outputLength = values[2].toInt()
+        val submitTime = values[3]
+        val completionTime = values[4]
+        val gpuTime = values[5]
+    }
+
     companion object {
-        external fun create(taps: ByteBuffer, forceSingleQueue: Boolean): Long
-        external fun process(instance: Long, samples: ByteBuffer, sampleCount: Int, phi: Float, omega: Float)
+        const val MIN_DEPTH = 2
+        const val MAX_DEPTH = 8
+        const val MAX_INTERPOLATION = 4096
+        const val MAX_CHANNELS = 16
+        const val MAX_BLOCK_SIZE = 512 * 1024
+
+        external fun create(
+            taps: ByteBuffer, forceSingleQueue: Boolean, depth: Int, channels: Int,
+            interpolation: Int, decimation: Int, resamplerTaps: FloatArray, bakeTaps: Boolean,
+            halfPrecision: Boolean, sampleFormat: Int, maxBlockSize: Int, filterTaps: FloatArray, filterDecimation: Int,
+            demodulatorGain: Float, demodulatorTaps: ByteBuffer, demodulatorDecimations: IntArray, deemphasis: Float
+        ): Long
+        // Return the output samples of each channel, or -1 when they fail.
+        external fun process(instance: Long, samples: ByteBuffer?, sampleCount: Int, output: ByteBuffer?, phi: FloatArray, omega: FloatArray): Int
+        external fun processFile(instance: Long, file: Long, sampleCount: Int, output: ByteBuffer, phi: FloatArray, omega: FloatArray): Int
+        external fun flush(instance: Long, output: ByteBuffer): Int
+        external fun submit(instance: Long, samples: ByteBuffer?, sampleCount: Int, sequence: Long, phi: FloatArray, omega: FloatArray): Boolean
+        external fun poll(instance: Long, output: ByteBuffer?, completion: LongArray): Boolean
+        external fun await(instance: Long, sequence: Long, output: ByteBuffer?, completion: LongArray): Boolean
+        external fun inFlight(instance: Long): Int
+        external fun slotCount(instance: Long): Int
+        external fun currentSlot(instance: Long): Int
+        external fun outputStride(instance: Long): Int
+        external fun stagingBuffer(instance: Long, slot: Int): ByteBuffer?
+        external fun outputBuffer(instance: Long, slot: Int): ByteBuffer?
         external fun delete(instance: Long)
 
         fun isAvailable(ratio: Int): Boolean {
-            return ratio and (ratio - 1) == 0 && ratio > 1
+            return Vulkan.supportsDecimators() && ratio and (ratio - 1) == 0 && ratio > 1
+        }
+
+        // Number of filters, then the size and taps of each.
+        private fun tapBuffer(taps: Array<FloatArray>): ByteBuffer {
+            val tapBufferSize = Int.SIZE_BYTES + Int.SIZE_BYTES * taps.size + taps.sumOf { it.size } * Float.SIZE_BYTES
+            val tapBuffer = ByteBuffer.allocateDirect(tapBufferSize).order(ByteOrder.nativeOrder())
+
+            tapBuffer.putInt(taps.size)
+
+            for (filter in taps) {
+                tapBuffer.putInt(filter.size)
+                for (tap in filter) {
+                    tapBuffer.putFloat(tap)
+                }
+            }
+
+            return tapBuffer
         }
     }
 
@@ -29,12 +134,28 @@ class VulkanShiftDecimator(private val sampleRate: Int, private val ratio: Int,
 
     private val n = log2(ratio.toDouble()).toInt()
 
-    private var phi = 0.0f
-    private var omega = 0.0f
+    private val phi = FloatArray(channels)
+    private val omega = FloatArray(channels)
 
     private var floatArray = FloatArray(Complex32.MAX_ARRAY_SIZE * 2)
     private var buffer = ByteBuffer.allocateDirect(floatArray.size * Float.SIZE_BYTES).order(ByteOrder.nativeOrder())
 
+    // Mapped staging and output buffers of each ring slot.
+    private val stagingBuffers: Array<ByteBuffer>
+    private val outputBuffers: Array<ByteBuffer>
+
+    // Samples of a channel in outputBuffer(), channels follow each other.
+    val outputStride: Int
+
+    // Filled in by poll and await, see Completion.
+    private val completion = LongArray(6)
+
+    // Blocks submitted and not yet returned by poll or await, at most slotCount.
+    val slotCount: Int
+        get() = stagingBuffers.size
+    val inFlight: Int
+        get() = inFlight(instance)
+
     init {
         if (ratio and (ratio - 1) != 0) {
             throw IllegalArgumentException("Ratio must be a power of 2")
@@ -42,6 +163,21 @@ class VulkanShiftDecimator(private val sampleRate: Int, private val ratio: Int,
         if (ratio <= 1) {
             throw IllegalArgumentException("Ratio must be greater than 1")
         }
+        if (depth < MIN_DEPTH || depth > MAX_DEPTH) {
+            throw IllegalArgumentException("Depth must be between $MIN_DEPTH and $MAX_DEPTH")
+        }
+        if (interpolation <= 0 || interpolation > MAX_INTERPOLATION || decimation <= 0) {
+            throw IllegalArgumentException("Interpolation must be between 1 and $MAX_INTERPOLATION, decimation greater than 0")
+        }
+        if (channels < 1 || channels > MAX_CHANNELS) {
+            throw IllegalArgumentException("Channels must be between 1 and $MAX_CHANNELS")
+        }
+        if (maxBlockSize < 1 || maxBlockSize > MAX_BLOCK_SIZE) {
+            throw IllegalArgumentException("Max block size must be between 1 and $MAX_BLOCK_SIZE")
+        }
+        if (filterDecimation < 1) {
+            throw IllegalArgumentException("Filter decimation must be greater than 0")
+        }
 
         val taps = Array(n) { FloatArray(0) }
         for (i in 0 until n) {
@@ -49,43 +185,236 @@ class VulkanShiftDecimator(private val sampleRate: Int, private val ratio: Int,
         }
         taps.reverse()
 
-        val tapBufferSize = Int.SIZE_BYTES + Int.SIZE_BYTES * n + taps.sumOf { it.size } * Float.SIZE_BYTES
-        val tapBuffer = ByteBuffer.allocateDirect(tapBufferSize).order(ByteOrder.nativeOrder())
+        var demodulatorGain = 0.0f
+        var deemphasis = 1.0f
 
-        tapBuffer.putInt(n)
-
-        for (i in 0 until n) {
-            tapBuffer.putInt(taps[i].size)
-            for (j in 0 until taps[i].size) {
-                tapBuffer.putFloat(taps[i][j])
+        if (demodulator != null) {
+            if (demodulator.deviation <= 0 || demodulator.taps.size != demodulator.decimations.size || demodulator.decimations.any { it <= 0 }) {
+                throw IllegalArgumentException("Demodulator needs a deviation and a decimation greater than 0 for each filter")
             }
+
+            val inputRate = sampleRate.toDouble() / ratio * interpolation / decimation / (if (filterTaps.isNotEmpty()) filterDecimation else 1)
+            val outputRate = demodulator.decimations.fold(inputRate) { rate, factor -> rate / factor }
+
+            demodulatorGain = (inputRate / (2 * PI * demodulator.deviation)).toFloat()
+
+            // Same coefficient as the CPU de-emphasis, 1 when there is none.
+            val dt = 1.0f / outputRate.toFloat()
+            deemphasis = dt / (demodulator.tau + dt)
         }
 
-        instance = create(tapBuffer, forceSingleQueue)
+        instance = create(
+            tapBuffer(taps), forceSingleQueue, depth, channels, interpolation, decimation, resamplerTaps, bakeTaps, halfPrecision, sampleFormat.ordinal, maxBlockSize,
+            filterTaps, filterDecimation, demodulatorGain, tapBuffer(demodulator?.taps ?: arrayOf()), demodulator?.decimations ?: IntArray(0), deemphasis
+        )
         check(instance != 0L)
 
-        Log.d("VK", "Vulkan decimator, ratio: $ratio, stages: ${taps.size}, taps: ${taps.sumOf { it.size }}")
+        stagingBuffers = Array(slotCount(instance)) { stagingBuffer(instance, it)!!.order(ByteOrder.nativeOrder()) }
+        outputBuffers = Array(slotCount(instance)) { outputBuffer(instance, it)!!.order(ByteOrder.nativeOrder()) }
+        outputStride = outputStride(instance)
+
+        Log.d("VK", "Vulkan decimator, ratio: $ratio, stages: ${taps.size}, taps: ${taps.sumOf { it.size }}, depth: $depth, channels: $channels, " +
+                "resampler: $interpolation/$decimation, taps: ${resamplerTaps.size}, baked taps: $bakeTaps, " +
+                "half precision: $halfPrecision, sample format: $sampleFormat, max block size: $maxBlockSize, " +
+                "filter taps: ${filterTaps.size}, decimation: $filterDecimation, demodulator filters: ${demodulator?.decimations?.joinToString("/") ?: "none"}")
     }
 
     fun setShiftFrequency(frequency: Float) {
-        phi = 0.0f
-        omega = (frequency / sampleRate).toRadians()
+        setShiftFrequency(0, frequency)
+    }
+
+    fun setShiftFrequency(channel: Int, frequency: Float) {
+        phi[channel] = 0.0f
+        omega[channel] = (frequency / sampleRate).toRadians()
     }
 
     fun decimate(input: Complex32Array, output: Complex32Array, length: Int): Int {
+        return read(process(input, length), output)
+    }
+
+    // Decimates the block once for every channel, each with its own shift frequency.
+    fun decimate(input: Complex32Array, outputs: Array<Complex32Array>, length: Int): Int {
+        return read(process(input, length), outputs)
+    }
+
+    // Input is a direct buffer of raw samples in the sample format, as read from the device.
+    fun decimate(input: ByteBuffer, output: Complex32Array, length: Int): Int {
+        return read(process(input, length), output)
+    }
+
+    fun decimate(input: ByteBuffer, outputs: Array<Complex32Array>, length: Int): Int {
+        return read(process(input, length), outputs)
+    }
+
+    // Decimates the next length samples of the recording, wrapping around at its end.
+    fun decimate(file: VulkanIQFile, output: Complex32Array, length: Int): Int {
+        return read(process(file, length), output)
+    }
+
+    fun decimate(file: VulkanIQFile, outputs: Array<Complex32Array>, length: Int): Int {
+        return read(process(file, length), outputs)
+    }
+
+    // Staging buffer of the next block, samples in the sample format written to it are decimated by decimateInPlace without a copy.
+    fun stagingBuffer(): ByteBuffer {
+        return stagingBuffers[currentSlot(instance)].also { it.clear() }
+    }
+
+    // Decimates the samples written to stagingBuffer(), the outputs stay in outputBuffer() until the next block.
+    fun decimateInPlace(length: Int): Int {
+        check(length <= stagingBuffers[0].capacity() / sampleFormat.sampleSize)
+
+        return advance(process(instance, null, length, null, phi, omega), length)
+    }
+
+    // Outputs of the last block read in place, as interleaved floats, channel i starts at sample i * outputStride.
+    fun outputBuffer(): ByteBuffer {
+        return outputBuffers[currentSlot(instance)].also { it.clear() }
+    }
+
+    // Returns the outputs of the blocks still in flight after the last decimate call, the tail of a stream.
+    fun flush(output: Complex32Array): Int {
+        return read(flush(), output)
+    }
+
+    fun flush(outputs: Array<Complex32Array>): Int {
+        return read(flush(), outputs)
+    }
+
+    // Asynchronous interface: blocks are submitted without waiting for the GPU, and returned by poll or await in the order
+    // they were submitted, so that the caller decides how much work overlaps the GPU. Blocks larger than the maximum block size
+    // are split into chunks with consecutive sequence numbers, all submitted at once, each chunk needs a free slot.
+    fun submit(input: Complex32Array, length: Int, sequence: Long): Boolean {
+        check(sampleFormat == SampleFormat.F32) { "Sample arrays need the F32 sample format" }
+
+        reserve(length * 2)
         input.toArray(floatArray, 0, length)
         buffer.asFloatBuffer().put(floatArray, 0, length * 2)
 
-        process(instance, buffer, length, phi, omega)
+        return submit(buffer, length, sequence)
+    }
 
-        if (omega != 0.0f) {
-            phi = (phi + omega * length).mod(2 * PI.toFloat())
+    fun submit(input: ByteBuffer, length: Int, sequence: Long): Boolean {
+        check(input.isDirect && input.remaining() >= length * sampleFormat.sampleSize)
+        val maxBlockLength = stagingBuffers[0].capacity() / sampleFormat.sampleSize
+        val chunks = max(1, (length + maxBlockLength - 1) / maxBlockLength)
+        check(inFlight + chunks <= slotCount) { "Not enough free slots, poll or await the oldest blocks first" }
+
+        if (!submit(instance, input.slice(), length, sequence, phi, omega)) {
+            return false
         }
+        advance(0, length)
+
+        return true
+    }
+
+    // Returns the oldest block in flight if the GPU is done with it, null otherwise.
+    fun poll(output: Complex32Array): Completion? {
+        return poll()?.also { read(it.outputLength, output) }
+    }
+
+    fun poll(outputs: Array<Complex32Array>): Completion? {
+        return poll()?.also { read(it.outputLength, outputs) }
+    }
+
+    // Waits for the oldest block in flight, which must have been submitted with sequence.
+    fun await(sequence: Long, output: Complex32Array): Completion {
+        return await(sequence).also { read(it.outputLength, output) }
+    }
+
+    fun await(sequence: Long, outputs: Array<Complex32Array>): Completion {
+        return await(sequence).also { read(it.outputLength, outputs) }
+    }
+
+    private fun poll(): Completion? {
+        return if (poll(instance, buffer, completion)) Completion(completion) else null
+    }
+
+    private fun await(sequence: Long): Completion {
+        check(await(instance, sequence, buffer, completion)) { "Block $sequence is not the oldest block in flight" }
+        return Completion(completion)
+    }
+
+    private fun flush(): Int {
+        // Outputs of all blocks in flight are returned at once.
+        reserve(2 * channels * inFlight * outputStride)
+
+        return max(flush(instance, buffer), 0)
+    }
+
+    // Grows the array and the buffer shared by inputs and outputs to hold size floats.
+    private fun reserve(size: Int) {
+        if (size > floatArray.size) {
+            floatArray = FloatArray(size)
+            buffer = ByteBuffer.allocateDirect(size * Float.SIZE_BYTES).order(ByteOrder.nativeOrder())
+        }
+    }
+
+    // Floats returned for length samples, blocks larger than the maximum block size return the outputs of each chunk.
+    private fun outputSize(length: Int): Int {
+        val maxBlockLength = stagingBuffers[0].capacity() / sampleFormat.sampleSize
+        return 2 * channels * max(1, (length + maxBlockLength - 1) / maxBlockLength) * outputStride
+    }
 
-        buffer.asFloatBuffer().get(floatArray, 0, length / ratio * 2)
-        output.fromArray(floatArray, 0, length / ratio)
+    private fun read(outputLength: Int, output: Complex32Array): Int {
+        buffer.asFloatBuffer().get(floatArray, 0, outputLength * 2)
+        output.fromArray(floatArray, 0, outputLength)
+
+        return outputLength
+    }
+
+    private fun read(outputLength: Int, outputs: Array<Complex32Array>): Int {
+        buffer.asFloatBuffer().get(floatArray, 0, outputLength * 2 * channels)
+        for (i in 0 until channels) {
+            outputs[i].fromArray(floatArray, outputLength * i, outputLength)
+        }
+
+        return outputLength
+    }
+
+    private fun process(input: Complex32Array, length: Int): Int {
+        check(sampleFormat == SampleFormat.F32) { "Sample arrays need the F32 sample format" }
+
+        // The samples are staged before the outputs are written over them.
+        reserve(max(length * 2, outputSize(length)))
+        input.toArray(floatArray, 0, length)
+        buffer.asFloatBuffer().put(floatArray, 0, length * 2)
+
+        return process(buffer, length)
+    }
+
+    private fun process(input: ByteBuffer, length: Int): Int {
+        check(input.isDirect && input.remaining() >= length * sampleFormat.sampleSize)
+
+        // The input may be the shared buffer, which only grows before it holds samples.
+        if (input !== buffer) {
+            reserve(outputSize(length))
+        }
+
+        return advance(process(instance, input.slice(), length, buffer, phi, omega), length)
+    }
+
+    private fun process(file: VulkanIQFile, length: Int): Int {
+        check(file.sampleFormat == sampleFormat)
+
+        reserve(outputSize(length))
+
+        return advance(processFile(instance, file.instance, length, buffer, phi, omega), length)
+    }
+
+    // Shifter phases stay where they were when the native call fails, nothing was decimated.
+    private fun advance(outputLength: Int, length: Int): Int {
+        if (outputLength < 0) {
+            return 0
+        }
+
+        for (i in 0 until channels) {
+            if (omega[i] != 0.0f) {
+                phi[i] = (phi[i] + omega[i] * length).mod(2 * PI.toFloat())
+            }
+        }
 
-        return length / ratio
+        return outputLength
     }
 
     fun close() {
@@ -0,0 +1,75 @@
+package com.hypermagik.spectrum.lib.gpu
+
+import android.util.Log
+import com.hypermagik.spectrum.lib.data.Complex32
+import com.hypermagik.spectrum.lib.data.Complex32Array
+import com.hypermagik.spectrum.lib.utils.toArray
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import kotlin.math.min
+
+// Windowed power spectrum in dB, with exponential averaging and peak hold, for power of 2 sizes up to maxSize.
+class VulkanSpectrum(val maxSize: Int = MAX_SIZE) {
+    companion object {
+        const val MIN_SIZE = 16
+        const val MAX_SIZE = 1 shl 20
+
+        external fun create(maxSize: Int): Long
+        external fun setWindow(instance: Long, window: FloatArray): Boolean
+        external fun process(instance: Long, samples: ByteBuffer, size: Int, alpha: Float, reset: Boolean, spectrum: FloatArray, peaks: FloatArray?): Boolean
+        external fun delete(instance: Long)
+    }
+
+    private var instance: Long = 0
+
+    // Weight of each new frame in the averaged power, 1 disables averaging.
+    var averaging = 1.0f
+        set(value) {
+            field = value.coerceIn(0.0f, 1.0f)
+        }
+
+    private var reset = false
+
+    private var floatArray = FloatArray(min(maxSize, Complex32.MAX_ARRAY_SIZE) * 2)
+    private var buffer = ByteBuffer.allocateDirect(maxSize * 2 * Float.SIZE_BYTES).order(ByteOrder.nativeOrder())
+
+    init {
+        if (maxSize and (maxSize - 1) != 0 || maxSize < MIN_SIZE || maxSize > MAX_SIZE) {
+            throw IllegalArgumentException("Maximum size must be a power of 2 between $MIN_SIZE and $MAX_SIZE")
+        }
+
+        instance = create(maxSize)
+        check(instance != 0L)
+
+        Log.d("VK", "Vulkan spectrum, max size: $maxSize")
+    }
+
+    // Window for transforms of window.size samples, sizes without one use a rectangular window.
+    fun setWindow(window: FloatArray) {
+        check(setWindow(instance, window))
+    }
+
+    // Restarts averaging and peak hold with the next frame, which also happens when the size changes.
+    fun reset() {
+        reset = true
+    }
+
+    // Spectrum and peaks receive size levels each, with the center frequency in the middle.
+    fun analyze(samples: Complex32Array, size: Int, spectrum: FloatArray, peaks: FloatArray? = null) {
+        samples.toArray(floatArray, 0, size)
+        buffer.asFloatBuffer().put(floatArray, 0, size * 2)
+
+        analyze(buffer, size, spectrum, peaks)
+    }
+
+    // Samples are interleaved floats in native order, for sizes past the largest sample array.
+    fun analyze(samples: ByteBuffer, size: Int, spectrum: FloatArray, peaks: FloatArray? = null) {
+        check(process(instance, samples, size, averaging, reset, spectrum, peaks))
+        reset = false
+    }
+
+    fun close() {
+        delete(instance)
+        instance = 0
+    }
+}